@@ -10,8 +10,9 @@
 
 
 /**
-\brief Enables unicode for several classes.
+\brief Selects 'wchar_t' instead of 'char' (UTF-8) as default character type for the text class aliases (e.g. "TextField").
 \remarks The "Font" class always supports ASCII and UNICODE!
+The text class templates (e.g. "BasicTextField") are always available for 'char', 'char16_t', 'char32_t', and 'wchar_t'.
 */
 #ifndef TG_UNICODE
 //#   define TG_UNICODE
@@ -126,6 +126,8 @@ class Font
 
         int TextWidth(const std::string& text, std::size_t offset = 0, std::size_t len = std::string::npos) const;
         int TextWidth(const std::wstring& text, std::size_t offset = 0, std::size_t len = std::string::npos) const;
+        int TextWidth(const std::u16string& text, std::size_t offset = 0, std::size_t len = std::string::npos) const;
+        int TextWidth(const std::u32string& text, std::size_t offset = 0, std::size_t len = std::string::npos) const;
 
         const FontDescription& GetDesc() const
         {
@@ -10,6 +10,7 @@
 
 
 #include "Rect.h"
+#include "Unicode.h"
 
 #include <vector>
 #include <iostream>
@@ -109,22 +110,28 @@ class FontGlyphSet
         const FontGlyph& operator [] (char chr) const;
         //! Returns the font glyph for the specified UTF-16 character. If this character is not part of this glyph set, a dummy font glyph is returend.
         const FontGlyph& operator [] (wchar_t chr) const;
+        //! Returns the font glyph for the specified UTF-16 code unit. If this character is not part of this glyph set, a dummy font glyph is returend.
+        const FontGlyph& operator [] (char16_t chr) const;
+        //! Returns the font glyph for the specified decoded code point. If this character is not part of this glyph set, a dummy font glyph is returend.
+        const FontGlyph& operator [] (char32_t chr) const;
 
         //! Returns the font glyph for the specified UTF-8 character. If this character is not part of this glyph set, a dummy font glyph is returend.
         FontGlyph& operator [] (char chr);
         //! Returns the font glyph for the specified UTF-16 character. If this character is not part of this glyph set, a dummy font glyph is returend.
         FontGlyph& operator [] (wchar_t chr);
-
-        //! Returns the width of the specified text.
+        //! Returns the font glyph for the specified UTF-16 code unit. If this character is not part of this glyph set, a dummy font glyph is returend.
+        FontGlyph& operator [] (char16_t chr);
+        //! Returns the font glyph for the specified decoded code point. If this character is not part of this glyph set, a dummy font glyph is returend.
+        FontGlyph& operator [] (char32_t chr);
+
+        /**
+        \brief Returns the width of the specified text.
+        \remarks The text is decoded into code points, i.e. 'std::string' is treated as UTF-8 (see DecodeCodePoint).
+        */
         template <typename T>
         int TextWidth(const typename std::basic_string<T>& text) const
         {
-            int width = 0;
-
-            for (auto c : text)
-                width += (*this)[c].advance;
-
-            return width;
+            return TextWidth<T>(text, 0);
         }
 
         //! Returns the width of the specified sub text.
@@ -141,13 +148,97 @@ class FontGlyphSet
                 if (count == std::basic_string<T>::npos || count + position > text.size())
                     count = text.size() - position;
 
-                for (auto end = position + count; position < end; ++position)
-                    width += (*this)[text[position]].advance;
+                for (std::size_t i = 0; i < count;)
+                    width += (*this)[DecodeCodePoint(text.data() + position, count, i)].advance;
             }
 
             return width;
         }
 
+        /**
+        \brief Returns the width of the specified UTF-8 text.
+        \remarks This uses the vectorized advance table for all ASCII runs if the table is up to date.
+        \see UpdateAdvanceTable
+        */
+        int TextWidth(const std::string& text) const;
+
+        //! Returns the width of the specified UTF-8 sub text.
+        int TextWidth(const std::string& text, std::string::size_type position, std::string::size_type count = std::string::npos) const;
+
+        /**
+        \brief Returns the number of characters of the specified sub text, which fit into the specified width.
+        \param[in] text Specifies the text which is to be measured.
+        \param[in] position Specifies the start position within the text.
+        \param[in] count Specifies the maximal number of characters.
+        \param[in] maxWidth Specifies the maximal accumulated width of the characters.
+        \param[out] width Specifies the accumulated width of all characters which fit into 'maxWidth'.
+        \return Number of code units (beginning at 'position') which fit into 'maxWidth',
+        i.e. the index of the first character where the accumulated width exceeds 'maxWidth' is 'position' plus the return value.
+        This is always at a character boundary.
+        */
+        template <typename T>
+        typename std::basic_string<T>::size_type TextFit(
+            const typename std::basic_string<T>&        text,
+            typename std::basic_string<T>::size_type    position,
+            typename std::basic_string<T>::size_type    count,
+            int                                         maxWidth,
+            int&                                        width) const
+        {
+            width = 0;
+
+            if (position >= text.size())
+                return 0;
+
+            if (count == std::basic_string<T>::npos || count + position > text.size())
+                count = text.size() - position;
+
+            std::size_t i = 0;
+
+            while (i < count)
+            {
+                auto next = i;
+                auto advance = (*this)[DecodeCodePoint(text.data() + position, count, next)].advance;
+                if (width + advance > maxWidth)
+                    break;
+                width += advance;
+                i = next;
+            }
+
+            return i;
+        }
+
+        //! \see TextFit
+        std::string::size_type TextFit(
+            const std::string&      text,
+            std::string::size_type  position,
+            std::string::size_type  count,
+            int                     maxWidth,
+            int&                    width
+        ) const;
+
+        /**
+        \brief Updates the internal 256-entry advance table for all 8-bit characters.
+        \remarks This is used for the fast path of all UTF-8 "TextWidth" and "TextFit" functions.
+        Every non-constant glyph access (e.g. the non-constant subscript operator) invalidates this table,
+        so this function must be called again after all glyphs have been modified. "BuildFont" does this automatically.
+        \see TextWidth
+        \see TextFit
+        */
+        void UpdateAdvanceTable();
+
+        /**
+        \brief Returns the common advance of all glyphs, if this is a monospace glyph set. Otherwise, the return value is 0.
+        \remarks Glyphs without any advance (e.g. control characters) are ignored.
+        \see IsMonospace
+        */
+        int GetMonospaceAdvance() const;
+
+        //! Returns true if all glyphs (with a non-zero advance) have the same advance.
+        inline bool IsMonospace() const
+        {
+            return (GetMonospaceAdvance() > 0);
+        }
+
         //! Specifies whether this glyph set has a vertical or a horizontal text layout. By default false.
         bool            isVertical  = false;
 
@@ -159,6 +250,8 @@ class FontGlyphSet
         FontGlyphRange          glyphRange_;
         std::vector<FontGlyph>  glyphs_;
 
+        std::vector<int>        advanceTable_;  //!< Advances of all 8-bit characters. Empty if the table is out of date.
+
 };
 
 
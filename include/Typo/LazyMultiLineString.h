@@ -0,0 +1,194 @@
+/*
+ * LazyMultiLineString.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_LAZY_MULTI_LINE_STRING_H
+#define TG_LAZY_MULTI_LINE_STRING_H
+
+
+#include "MultiLineString.h"
+
+#include <vector>
+#include <unordered_map>
+
+
+namespace Tg
+{
+
+
+/**
+\brief Multi-line string class with lazy layout for huge texts.
+\tparam T Specifies the character type (see BasicTextField).
+\remarks The text is split into paragraphs at each new-line character, but a paragraph is only wrapped
+(in the same way as BasicMultiLineString does) when a query touches it. All other paragraphs only have an estimated number of lines.
+Therefore, line indices refer to the current layout state and can change while more paragraphs are wrapped.
+Use GetTextPosition and GetTextIndex to keep a stable position within the text.
+*/
+template <typename T>
+class BasicLazyMultiLineString
+{
+
+    public:
+
+        //! String type alias.
+        using StringType = std::basic_string<T>;
+
+        //! String size type alias.
+        using SizeType = typename StringType::size_type;
+
+        //! Text line type alias.
+        using TextLine = typename BasicMultiLineString<T>::TextLine;
+
+        BasicLazyMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const StringType& text);
+
+        //! Sets the content of the multi-line string and discards all wrapped paragraphs.
+        void SetText(const StringType& text);
+
+        /**
+        \brief Appends the specified string to the end of the text.
+        \remarks Only the last paragraph is discarded, all other wrapped paragraphs remain valid.
+        */
+        void Append(const StringType& text);
+
+        //! Returns the base text.
+        inline const StringType& GetText() const
+        {
+            return text_;
+        }
+
+        //! Sets the new font glyph set and discards all wrapped paragraphs.
+        void SetGlyphSet(const FontGlyphSet& glyphSet);
+
+        //! Returns the current font glyph set for this multi-line string.
+        inline const FontGlyphSet& GetGlyphSet() const
+        {
+            return *glyphSet_;
+        }
+
+        //! Sets the new maximal width and discards all wrapped paragraphs.
+        void SetMaxWidth(int maxWidth);
+
+        //! Returns the maximal width.
+        inline int GetMaxWidth() const
+        {
+            return maxWidth_;
+        }
+
+        //! Returns the number of paragraphs, i.e. the number of new-line characters plus one (or zero for an empty text).
+        inline SizeType GetParagraphCount() const
+        {
+            return (paragraphOffsets_.empty() ? 0 : paragraphOffsets_.size() - 1);
+        }
+
+        /**
+        \brief Returns the number of lines.
+        \remarks This is only an estimate, until all paragraphs have been wrapped.
+        \see IsLineCountExact
+        */
+        SizeType GetLineCount() const;
+
+        //! Returns true if all paragraphs have been wrapped, i.e. the number of lines is exact.
+        inline bool IsLineCountExact() const
+        {
+            return (layouts_.size() == GetParagraphCount());
+        }
+
+        /**
+        \brief Returns the specified text line, and wraps its paragraph if necessary.
+        \param[in] lineIndex Specifies the line index. This will be clamped to the range [0, GetLineCount()).
+        \remarks The returned reference is valid until the text, glyph set, or maximal width is changed.
+        If the text is empty, a static empty line is returned.
+        */
+        const TextLine& GetLine(SizeType lineIndex);
+
+        /**
+        \brief Returns the specified range of text lines (i.e. the lines of the viewport), and wraps their paragraphs if necessary.
+        \param[in] firstLine Specifies the index of the first line.
+        \param[in] numLines Specifies the number of lines.
+        \param[out] lines Specifies the output list of lines. This is cleared first.
+        \return Index of the first output line, i.e. 'firstLine' clamped to the range [0, GetLineCount()).
+        */
+        SizeType GetLines(SizeType firstLine, SizeType numLines, std::vector<TextLine>& lines);
+
+        /**
+        \brief Converts the specified position into a string index within the main text string.
+        \return Position within the main text string or 'StringType::npos' if the specified location is invalid.
+        \see BasicMultiLineString::GetTextIndex
+        */
+        SizeType GetTextIndex(SizeType lineIndex, SizeType positionInLine);
+
+        /**
+        \brief Converts the specified string index within the main text string into a position, and wraps its paragraph if necessary.
+        \see BasicMultiLineString::GetTextPosition
+        */
+        void GetTextPosition(SizeType textIndex, SizeType& lineIndex, SizeType& positionInLine);
+
+    private:
+
+        //! Returns the estimated number of lines of the specified paragraph.
+        SizeType EstimateLineCount(SizeType paragraph) const;
+
+        //! Returns the current number of lines of the specified paragraph (estimated or exact).
+        SizeType ParagraphLineCount(SizeType paragraph) const;
+
+        //! Wraps the specified paragraph (if not already done) and returns its lines.
+        const std::vector<TextLine>& LayoutParagraph(SizeType paragraph);
+
+        /**
+        Finds the paragraph which contains the specified line (clamped to the range [0, GetLineCount())),
+        and wraps it. Returns the paragraph index and its first line index.
+        */
+        SizeType FindLine(SizeType& lineIndex, SizeType& firstLineOfParagraph);
+
+        //! Appends the paragraphs of the main text, which begin at or after the specified offset.
+        void AppendParagraphs(SizeType offset);
+
+        //! Discards all wrapped paragraphs and rebuilds the estimated line counts.
+        void ResetLayouts();
+
+        //! Updates the average advance of the printable ASCII characters, which is used to estimate the line counts.
+        void UpdateAverageAdvance();
+
+        /* --- Line count tree (Fenwick tree over the line counts of all paragraphs) --- */
+
+        void TreeAppend(SizeType count);
+        void TreeAdd(SizeType paragraph, SizeType delta);
+        SizeType TreePrefix(SizeType numParagraphs) const;
+        SizeType TreeFind(SizeType lineIndex) const;
+
+        /* === Member === */
+
+        const FontGlyphSet*                                 glyphSet_;
+
+        int                                                 maxWidth_;
+        int                                                 averageAdvance_     = 1;
+
+        StringType                                          text_;
+
+        std::vector<SizeType>                               paragraphOffsets_;  // Begin of each paragraph plus the end of the text (plus one)
+        std::vector<SizeType>                               lineTree_;          // Fenwick tree (1-based) of the line count of each paragraph
+        std::unordered_map<SizeType, std::vector<TextLine>> layouts_;           // Lines of all wrapped paragraphs
+
+};
+
+
+extern template class BasicLazyMultiLineString<char>;
+extern template class BasicLazyMultiLineString<char16_t>;
+extern template class BasicLazyMultiLineString<char32_t>;
+extern template class BasicLazyMultiLineString<wchar_t>;
+
+//! Lazy multi-line string with the default character type (see Tg::Char).
+using LazyMultiLineString = BasicLazyMultiLineString<Char>;
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
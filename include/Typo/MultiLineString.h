@@ -11,6 +11,7 @@
 
 #include "Char.h"
 #include "Font.h"
+#include "TextAttribute.h"
 
 #include <vector>
 
@@ -21,15 +22,26 @@ namespace Tg
 
 /**
 \brief Multi-line string class.
+\tparam T Specifies the character type (see BasicTextField).
 \remarks This can be used to easily manage multi-line text inside a restricted area.
+All positions are indices of code units (e.g. bytes for UTF-8), but lines are only broken at character (i.e. code point) boundaries.
+Lines are wrapped at the line break opportunities of the Unicode line breaking algorithm (UAX #14),
+which are computed once whenever the text changes. If no break opportunity fits into a line, the line is broken at the last character that fits.
+The cumulative character widths are cached as well, so changing the maximal width only needs a binary search over the break points per line.
+Large texts are split into chunks of whole paragraphs, which are rebuilt in parallel.
+Text attributes (e.g. colors) are stored as run-length spans over the main text, which are moved along with every text modification.
 */
-class MultiLineString
+template <typename T>
+class BasicMultiLineString
 {
     
     public:
         
+        //! String type alias.
+        using StringType = std::basic_string<T>;
+
         //! String size type alias.
-        using SizeType = String::size_type;
+        using SizeType = typename StringType::size_type;
 
         struct TextLine
         {
@@ -37,25 +49,27 @@ class MultiLineString
             {
                 // dummy (can not be defaulted for clang compiler!)
             }
-            TextLine(const String& text, int width) :
-                text  { text  },
-                width { width }
+            TextLine(const StringType& text, int width, SizeType offset = 0) :
+                text   { text   },
+                width  { width  },
+                offset { offset }
             {
             }
 
-            String  text;
-            int     width = 0;
+            StringType  text;
+            int         width   = 0;
+            SizeType    offset  = 0; //!< Index of the first character of this line within the main text.
         };
         
-        MultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const String& text);
+        BasicMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const StringType& text);
         
-        MultiLineString& operator = (const String& str);
+        BasicMultiLineString& operator = (const StringType& str);
         
-        MultiLineString& operator += (const String& str);
+        BasicMultiLineString& operator += (const StringType& str);
         
-        MultiLineString& operator += (const Char& chr);
+        BasicMultiLineString& operator += (const T& chr);
         
-        inline operator const String& () const
+        inline operator const StringType& () const
         {
             return text_;
         }
@@ -65,10 +79,10 @@ class MultiLineString
         \param[in] chr Specifies the new character.
         \see GetText
         */
-        void PushBack(const Char& chr);
+        void PushBack(const T& chr);
         
         /**
-        \brief Removes the last character from the base string and updates the affected line.
+        \brief Removes the last character (i.e. code point) from the base string and updates the affected line.
         \see GetText
         */
         void PopBack();
@@ -80,12 +94,26 @@ class MultiLineString
         This value must be in the range [0, line.size()], i.e. it can also be at the end of the string (not only line.size() - 1).
         \param[in] chr Specifies the new character. This can also be a new line character.
         \param[in] replace Specifies whether to replace the previous character or insert a new one. By default false.
+        If 'chr' is the lead unit of a character, the entire character at the specified position is replaced.
+        If 'chr' is a continuation unit (see IsContinuationUnit), it is always inserted.
+        \remarks If the position (i.e. 'lineIndex' and 'positionInLine') are invalid, this function call has no effect.
+        */
+        void Insert(SizeType lineIndex, SizeType positionInLine, const T& chr, bool replace = false);
+
+        /**
+        \brief Inserts the specified string at the specified location and updates all lines only once.
+        \param[in] lineIndex Specifies the line where to insert the new string.
+        \param[in] positionInLine Specifies the position within the specified line string (see Insert).
+        \param[in] str Specifies the new string. This can also contain new line characters.
+        \param[in] replace Specifies whether to replace the previous characters or insert new ones. By default false.
+        If true, each character of 'str' (except new line characters) replaces one character of the text, until the end of the current paragraph is reached.
+        The result is the same as inserting each code unit of 'str' separately with Insert(SizeType, SizeType, const T&, bool).
         \remarks If the position (i.e. 'lineIndex' and 'positionInLine') are invalid, this function call has no effect.
         */
-        void Insert(SizeType lineIndex, SizeType positionInLine, const Char& chr, bool replace = false);
+        void Insert(SizeType lineIndex, SizeType positionInLine, const StringType& str, bool replace = false);
 
         /**
-        \brief Removes the character at the specified location.
+        \brief Removes the character (i.e. all code units of the code point) at the specified location.
         \param[in] lineIndex Specifies the line where to remove a character.
         \param[in] positionInLine Specifies the position within the specified line string.
         This value must be in the range [0, line.size()), i.e. it can not be at the end of the string (only line.size() - 1).
@@ -93,12 +121,31 @@ class MultiLineString
         */
         void Remove(SizeType lineIndex, SizeType positionInLine);
 
+        /**
+        \brief Removes the specified number of code units at the specified location and updates all lines only once.
+        \param[in] lineIndex Specifies the line where to begin the removal.
+        \param[in] positionInLine Specifies the position within the specified line string. This must be a code point boundary.
+        \param[in] length Specifies the number of code units to remove. This will be clamped to the end of the main text.
+        \remarks If the position (i.e. 'lineIndex' and 'positionInLine') are invalid, this function call has no effect.
+        */
+        void Remove(SizeType lineIndex, SizeType positionInLine, SizeType length);
+
+        /**
+        \brief Erases whole paragraphs from the front, until at most 'maxLines' lines and 'maxLength' code units remain.
+        \param[in] maxLines Specifies the maximal number of lines which are kept.
+        \param[in] maxLength Specifies the maximal number of code units which are kept.
+        \return Number of code units which have been erased from the front of the main text.
+        \remarks The last paragraph is never erased. The remaining lines are not rewrapped,
+        only their offsets and the cached widths are moved to the front.
+        */
+        SizeType TrimFront(SizeType maxLines, SizeType maxLength);
+
         /**
         \brief Converts the specified position into a string index within the main text string.
         \param[in] lineIndex Specifies the index of the text line.
         \param[in] positionInLine Specifies the position within the specified line string.
         This value must be in the range [0, line.size()], i.e. it can also be at the end of the string (not only line.size() - 1).
-        \return Position within the main text string or 'String::npos' if the specified location is invalid.
+        \return Position within the main text string or 'StringType::npos' if the specified location is invalid.
         \remarks The return value is in the range [0, GetText().size()], i.e. it can exceed the main text position by 1 character!
         \see GetText
         \see GetTextPosition
@@ -116,6 +163,39 @@ class MultiLineString
         */
         void GetTextPosition(SizeType textIndex, SizeType& lineIndex, SizeType& positionInLine) const;
 
+        /**
+        \brief Returns the width of the specified line from its beginning up to the specified position.
+        \param[in] positionInLine Specifies the position within the line string. This will be clamped to the range [0, line.size()].
+        \remarks This is an O(1) lookup into the cumulative character widths, which are stored for the entire text.
+        \see FontGlyphSet::TextWidth
+        */
+        int LineWidth(SizeType lineIndex, SizeType positionInLine) const;
+
+        /**
+        \brief Returns the position within the specified line, up to which the line width (from its beginning) does not exceed 'maxWidth'.
+        \param[out] width Specifies the width of the line up to the returned position.
+        \remarks This is an O(log n) binary search over the cumulative character widths. The return value is always at a character boundary.
+        \see FontGlyphSet::TextFit
+        */
+        SizeType LineFit(SizeType lineIndex, int maxWidth, int& width) const;
+
+        /**
+        \brief Returns the position within the specified line, which is closest to the specified X coordinate.
+        \param[in] x Specifies the X coordinate (in pixels) relative to the beginning of the line.
+        \remarks The return value is always at a character boundary. This is an O(log n) binary search (see LineFit).
+        */
+        SizeType LineHitTest(SizeType lineIndex, int x) const;
+
+        /**
+        \brief Returns the index within the main text, which is closest to the specified point.
+        \param[in] x Specifies the X coordinate (in pixels) relative to the beginning of the lines.
+        \param[in] y Specifies the Y coordinate (in pixels) relative to the top of the first line.
+        \param[in] lineHeight Specifies the height of each line (in pixels). Points above or below all lines hit the first or last line.
+        \remarks The end of a wrapped line hits its last character, since that index already belongs to the next line (see GetTextPosition).
+        This is an O(log n) search, which does not walk over the lines.
+        */
+        SizeType HitTest(int x, int y, int lineHeight) const;
+
         /**
         \brief Sets the new font glyph set and updates all lines.
         \see GetLines
@@ -148,10 +228,10 @@ class MultiLineString
         }
         
         //! Sets the content of the multi-line string and resets all lines.
-        void SetText(const String& text);
+        void SetText(const StringType& text);
 
         //! Returns the base text.
-        inline const String& GetText() const
+        inline const StringType& GetText() const
         {
             return text_;
         }
@@ -165,17 +245,70 @@ class MultiLineString
             return lines_;
         }
 
-        //! Returns the width of the specified character
-        virtual int CharWidth(const Char& chr) const;
+        /**
+        \brief Returns the layout version, which changes whenever the lines are rebuilt or moved.
+        \remarks This can be used to invalidate data which depends on the lines, e.g. a cached cursor coordinate.
+        */
+        inline std::size_t GetLayoutVersion() const
+        {
+            return layoutVersion_;
+        }
+
+        /**
+        \brief Sets the attribute for all subsequently inserted characters. By default the default attribute.
+        \remarks Replaced characters get this attribute as well.
+        \see GetAttributeSpans
+        */
+        inline void SetAttribute(const TextAttribute& attribute)
+        {
+            attribute_ = attribute;
+        }
+
+        //! Returns the attribute for all subsequently inserted characters.
+        inline const TextAttribute& GetAttribute() const
+        {
+            return attribute_;
+        }
+
+        /**
+        \brief Returns the list of all attribute spans, sorted by their offsets.
+        \remarks If this list is empty, the entire text has the default attribute.
+        Otherwise the first span begins at offset 0, and each span has a different attribute than its predecessor.
+        \see GetAttributeAt
+        */
+        inline const std::vector<TextAttributeSpan>& GetAttributeSpans() const
+        {
+            return attributeSpans_;
+        }
+
+        //! Returns the index of the attribute span, which contains the specified text index, or 0 if there are no spans.
+        SizeType FindAttributeSpan(SizeType textIndex) const;
+
+        //! Returns the attribute of the character at the specified text index.
+        TextAttribute GetAttributeAt(SizeType textIndex) const;
+
+        /**
+        \brief Returns the width of the specified character (i.e. decoded code point).
+        \remarks For large texts, this is called from multiple threads concurrently.
+        */
+        virtual int CharWidth(char32_t chr) const;
         
         //! Returns true if the specified character is a new-line character, i.e. '\n' (line-feed) or '\r' (carriage return).
-        bool IsNewLine(const Char& chr) const;
+        bool IsNewLine(char32_t chr) const;
         
         //! Returns true if the specified character is a space character, i.e. ' ' or '\t'.
-        bool IsSpace(const Char& chr) const;
+        bool IsSpace(char32_t chr) const;
 
     private:
         
+        //! Line break opportunity with the cumulative width up to its last non-space character.
+        struct BreakPoint
+        {
+            SizeType    position;   // Position where the next line may begin (or the new-line character for mandatory breaks)
+            int         width;      // Cumulative width of all characters before 'position' without trailing spaces
+            bool        mandatory;  // Specifies whether this is the end of a paragraph
+        };
+
         //! Returns true if the specified width fits into a line, i.e. does not exceed the maximal width.
         bool FitIntoLine(int width) const;
         
@@ -193,40 +326,69 @@ class MultiLineString
         */
         void UpdateWidestWidth();
         
-        //! Appends a new text line with the specified string and width.
-        void AppendLine(const String& text, int width);
-        
-        //! Appends a new text line with the specified character and width.
-        void AppendLine(const Char& chr, int width);
-        
-        //! Appends a new empty text line.
-        void AppendLine();
+        /**
+        \brief Rebuilds the text chunks and the positions of all break points from the main text.
+        \remarks This must be called whenever the main text changes.
+        */
+        void RebuildBreaks();
+
+        /**
+        \brief Rebuilds the cumulative character widths and the widths of all break points from the main text.
+        \remarks This must be called whenever the main text or the glyph set changes, and after RebuildBreaks.
+        */
+        void RebuildAdvances();
 
-        //! Rebuilds all text lines from the main text.
+        //! Rebuilds all text lines from the break points. This does not query any character widths.
         void RebuildLines();
-        
+
+        //! Wraps all paragraphs of the specified text chunk into the output lines.
+        void WrapChunk(SizeType chunk, std::vector<TextLine>& lines) const;
+
         /**
-        \brief Appends the next sub-string from the main text to the text lines.
-        \return Index within the main text after appending the new sub-string.
+        \brief Moves the attribute spans after 'removed' code units at position 'pos' have been replaced by 'inserted' code units.
+        \remarks The inserted code units get the current attribute (see SetAttribute).
         */
-        SizeType AppendLinesFromSubText(SizeType offset);
+        void UpdateAttributeSpans(SizeType pos, SizeType removed, SizeType inserted);
 
-        //! Appends a sub-string from the main text to the text lines.
-        SizeType AppendLineFromSubText(SizeType start, SizeType end, int subTextWidth);
+        /**
+        \brief Returns the end of the longest sub-string in the range [start, end), which fits into a line,
+        but at least one character (i.e. code point). This is used when no break opportunity fits into a line.
+        */
+        SizeType FitCodePoints(SizeType start, SizeType end) const;
 
         /* === Member === */
 
-        const FontGlyphSet*     glyphSet_;
+        const FontGlyphSet*         glyphSet_;
         
-        int                     maxWidth_;
-        int                     width_;
+        int                         maxWidth_;
+        int                         width_;
         
-        String                  text_;
-        std::vector<TextLine>   lines_;
+        StringType                  text_;
+        std::vector<TextLine>       lines_;
+
+        std::vector<int>            advances_;      // Cumulative width of all characters which end at or before each position
+        std::vector<BreakPoint>     breakPoints_;
+
+        std::vector<SizeType>       chunks_;        // Begin of each text chunk (always a paragraph begin) plus the end of the text (plus one)
+        std::vector<SizeType>       chunkBreaks_;   // Index of the first break point of each text chunk plus the number of break points
+
+        TextAttribute                   attribute_;
+        std::vector<TextAttributeSpan>  attributeSpans_;
+
+        std::size_t                     layoutVersion_  = 0;
         
 };
 
 
+extern template class BasicMultiLineString<char>;
+extern template class BasicMultiLineString<char16_t>;
+extern template class BasicMultiLineString<char32_t>;
+extern template class BasicMultiLineString<wchar_t>;
+
+//! Multi-line string with the default character type (see Tg::Char).
+using MultiLineString = BasicMultiLineString<Char>;
+
+
 } // /namespace Tg
 
 
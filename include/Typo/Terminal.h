@@ -12,31 +12,96 @@
 #include "TextFieldMultiLineString.h"
 #include <iostream>
 #include <memory>
+#include <string>
 
 
 namespace Tg
 {
 
 
+class TerminalStreamBuf;
+
 //! Terminal class, representing the 'model' within the model-view-controller pattern.
 class Terminal
 {
 
-    private:
-
-        std::unique_ptr<std::streambuf> streamBuf_;
-
     public:
 
-        Terminal(const FontGlyphSet& glyphSet, int maxWidth);
+        /**
+        \brief Terminal constructor.
+        \param[in] glyphSet Specifies the glyph set for the text field.
+        \param[in] maxWidth Specifies the maximal width of the text field.
+        \param[in] postQueueCapacity Specifies how many posted texts can be pending, before further posts are dropped (see Post).
+        This is rounded up to the next power of two. By default 1024.
+        */
+        Terminal(const FontGlyphSet& glyphSet, int maxWidth, std::size_t postQueueCapacity = 1024);
+
+        /**
+        \brief Enqueues the specified text for the terminal output without blocking.
+        \return True on success, or false if the queue is full. In this case, the text is dropped.
+        \remarks This is the only function, which can be called from any thread.
+        The text is written into the text field, when the thread which owns this terminal calls Drain.
+        Special characters are handled as for the 'out' stream.
+        \see Drain
+        \see GetNumDroppedPosts
+        */
+        bool Post(const std::string& text);
+
+        /**
+        \brief Writes all posted texts into the text field at once.
+        \return Number of texts which have been written.
+        \remarks This should be called once per frame, by the thread which owns this terminal.
+        This also flushes the output stream before the posted texts are written.
+        \see Post
+        */
+        std::size_t Drain();
+
+        //! Returns the number of texts which have been dropped, because the post queue was full.
+        std::size_t GetNumDroppedPosts() const;
+
+        //! Returns the number of characters (i.e. code units) which have been dropped, because the post queue was full.
+        std::size_t GetNumDroppedChars() const;
+
+        /**
+        \brief Sets the scrollback limit, i.e. the maximal number of lines and code units the terminal keeps. By default 0, i.e. no limit.
+        \remarks Whole paragraphs are dropped from the front of the text field, once the output stream exceeds a limit by one eighth.
+        This keeps memory and the cost of appending new output constant for long-running terminals.
+        This also flushes the output stream.
+        */
+        void SetScrollbackLimit(std::size_t maxLines, std::size_t maxLength = 0);
+
+        /**
+        \brief Commits the user input, i.e. all text after the last output, as new line to the input stream.
+        \remarks A new-line character is appended to the text field, and the line can then be read from 'in', e.g. with 'std::getline'.
+        This also clears the error state of 'in', which has been set when it ran out of input.
+        \see in
+        */
+        void CommitInput();
 
         //! Text field multi line string.
         TextFieldMultiLineString textField;
 
-        //! Terminal input stream.
+    private:
+
+        TerminalStreamBuf* GetStreamBuf() const;
+
+        // Must be declared after the text field and before the streams, which all depend on the construction order.
+        std::unique_ptr<std::streambuf> streamBuf_;
+
+    public:
+
+        /**
+        \brief Terminal input stream.
+        \remarks Reading from this stream never blocks. If no committed input is available, the stream reaches its end,
+        and 'in.rdbuf()->in_avail()' can be used to check how many characters are available.
+        \see CommitInput
+        */
         std::istream in;
 
-        //! Terminal output stream.
+        /**
+        \brief Terminal output stream.
+        \remarks This stream is buffered, i.e. the text field is only updated when the stream is flushed (e.g. with 'std::flush' or 'std::endl').
+        */
         std::ostream out;
 
 };
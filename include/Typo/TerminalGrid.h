@@ -0,0 +1,187 @@
+/*
+ * TerminalGrid.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_TERMINAL_GRID_H
+#define TG_TERMINAL_GRID_H
+
+
+#include "FontGlyphSet.h"
+#include "TextAttribute.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace Tg
+{
+
+
+//! Single character cell of a terminal grid.
+struct TerminalCell
+{
+    TerminalCell() = default;
+
+    inline TerminalCell(char32_t chr, const TextAttribute& attribute) :
+        chr       { chr       },
+        attribute { attribute }
+    {
+    }
+
+    char32_t        chr         = U' ';
+    TextAttribute   attribute;
+};
+
+class TerminalGridStreamBuf;
+
+/**
+\brief Terminal with a fixed grid of character cells for monospace glyph sets.
+\remarks In contrast to the Terminal class, the output is not wrapped and measured, but written into a grid of
+rows and columns. Writing a character and rendering a cell is O(1), and scrolling recycles the top row.
+The output is UTF-8 encoded and may contain the same ANSI escape sequences as for the Terminal class,
+plus ED (i.e. "ESC[2J") to erase the display. Rows and columns of escape sequences are 1-based.
+\see FontGlyphSet::IsMonospace
+*/
+class TerminalGrid
+{
+
+    public:
+
+        /**
+        \brief Terminal grid constructor.
+        \param[in] glyphSet Specifies the glyph set. This must be a monospace glyph set.
+        \param[in] numColumns Specifies the number of columns (at least 1).
+        \param[in] numRows Specifies the number of rows (at least 1).
+        \throws std::runtime_error If the glyph set is not a monospace glyph set.
+        */
+        TerminalGrid(const FontGlyphSet& glyphSet, std::size_t numColumns, std::size_t numRows);
+
+        ~TerminalGrid();
+
+        //! Writes the specified UTF-8 text into the grid. This also flushes the output stream.
+        void Write(const std::string& text);
+
+        //! Resizes the grid. The cursor row is kept visible, and all other rows keep their content as far as possible.
+        void Resize(std::size_t numColumns, std::size_t numRows);
+
+        //! Clears all cells and moves the cursor to the top-left cell.
+        void Clear();
+
+        //! Scrolls the content up by the specified number of rows. The new rows at the bottom are empty.
+        void ScrollUp(std::size_t numRows = 1);
+
+        //! Returns the first cell of the specified row. All cells of a row are stored consecutively.
+        const TerminalCell* GetRow(std::size_t row) const;
+
+        //! Returns the cell at the specified column and row.
+        inline const TerminalCell& GetCell(std::size_t column, std::size_t row) const
+        {
+            return GetRow(row)[column];
+        }
+
+        //! Moves the cursor to the specified column and row (0-based). Both are clamped to the grid.
+        void SetCursor(std::size_t column, std::size_t row);
+
+        //! Returns the column of the cursor (0-based). This can be equal to the number of columns, after the last column has been written.
+        inline std::size_t GetCursorColumn() const
+        {
+            return cursorColumn_;
+        }
+
+        //! Returns the row of the cursor (0-based).
+        inline std::size_t GetCursorRow() const
+        {
+            return cursorRow_;
+        }
+
+        //! Sets the attribute for all subsequently written characters.
+        inline void SetAttribute(const TextAttribute& attribute)
+        {
+            attribute_ = attribute;
+        }
+
+        //! Returns the attribute for all subsequently written characters.
+        inline const TextAttribute& GetAttribute() const
+        {
+            return attribute_;
+        }
+
+        //! Returns the number of columns.
+        inline std::size_t GetNumColumns() const
+        {
+            return numColumns_;
+        }
+
+        //! Returns the number of rows.
+        inline std::size_t GetNumRows() const
+        {
+            return numRows_;
+        }
+
+        //! Returns the width of each cell, i.e. the common advance of the monospace glyph set.
+        inline int GetCellWidth() const
+        {
+            return cellWidth_;
+        }
+
+        //! Returns the glyph set of this terminal grid.
+        inline const FontGlyphSet& GetGlyphSet() const
+        {
+            return *glyphSet_;
+        }
+
+    private:
+
+        friend class TerminalGridStreamBuf;
+
+        //! Writes the specified character at the cursor and moves the cursor to the next cell.
+        void PutChar(char32_t chr);
+
+        //! Moves the cursor to the beginning of the next row and scrolls up if the cursor is in the last row.
+        void LineFeed();
+
+        //! Executes the specified control sequence (see EscapeSequenceHandler).
+        void ExecuteControlSequence(char command, const int* params, std::size_t numParams);
+
+        //! Fills the cells in the range [first, last) of the specified row with spaces of the current attribute.
+        void EraseCells(std::size_t row, std::size_t first, std::size_t last);
+
+        TerminalCell* GetMutableRow(std::size_t row);
+
+        const FontGlyphSet*                     glyphSet_;
+        int                                     cellWidth_      = 0;
+
+        std::size_t                             numColumns_     = 0;
+        std::size_t                             numRows_        = 0;
+        std::size_t                             firstRow_       = 0;    // Index of the top row within the cells (rows are rotated when scrolling)
+        std::vector<TerminalCell>               cells_;
+
+        std::size_t                             cursorColumn_   = 0;
+        std::size_t                             cursorRow_      = 0;
+        TextAttribute                           attribute_;
+
+        std::unique_ptr<TerminalGridStreamBuf>  streamBuf_;
+
+    public:
+
+        /**
+        \brief Terminal grid output stream.
+        \remarks This stream is buffered, i.e. the grid is only updated when the stream is flushed (e.g. with 'std::flush' or 'std::endl').
+        */
+        std::ostream out;
+
+};
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,79 @@
+/*
+ * TextAttribute.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_TEXT_ATTRIBUTE_H
+#define TG_TEXT_ATTRIBUTE_H
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Tg
+{
+
+
+//! Text attribute flags enumeration.
+struct TextAttributeFlags
+{
+    enum
+    {
+        Bold        = (1 << 0),
+        Italic      = (1 << 1),
+        Underlined  = (1 << 2),
+        Inverse     = (1 << 3), //!< Foreground and background colors are swapped.
+        Foreground  = (1 << 4), //!< The 'foreground' color is used instead of the default foreground color.
+        Background  = (1 << 5), //!< The 'background' color is used instead of the default background color.
+    };
+};
+
+//! Text attribute structure, e.g. for colored terminal output. The default attribute has default colors and no flags.
+struct TextAttribute
+{
+    std::uint32_t   foreground  = 0; //!< Foreground color in the format 0xRRGGBB. Only used if 'flags' contains 'TextAttributeFlags::Foreground'.
+    std::uint32_t   background  = 0; //!< Background color in the format 0xRRGGBB. Only used if 'flags' contains 'TextAttributeFlags::Background'.
+    int             flags       = 0; //!< This can be a bitwise OR combination of the values of the 'TextAttributeFlags' enumeration.
+};
+
+/**
+\brief Run-length span of text attributes.
+\remarks A span begins at its offset within the main text and ends at the offset of the next span (or the end of the text).
+*/
+struct TextAttributeSpan
+{
+    TextAttributeSpan() = default;
+
+    inline TextAttributeSpan(std::size_t offset, const TextAttribute& attribute) :
+        offset    { offset    },
+        attribute { attribute }
+    {
+    }
+
+    std::size_t     offset      = 0;
+    TextAttribute   attribute;
+};
+
+
+inline bool operator == (const TextAttribute& lhs, const TextAttribute& rhs)
+{
+    return (lhs.foreground == rhs.foreground && lhs.background == rhs.background && lhs.flags == rhs.flags);
+}
+
+inline bool operator != (const TextAttribute& lhs, const TextAttribute& rhs)
+{
+    return !(lhs == rhs);
+}
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
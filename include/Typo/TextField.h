@@ -20,16 +20,28 @@ namespace Tg
 {
 
 
-//! Base class for all text fields.
-class TextField
+/**
+\brief Base class for all text fields.
+\tparam T Specifies the character type. Explicit instantiations exist for 'char' (UTF-8), 'char16_t' (UTF-16), 'char32_t' (UTF-32), and 'wchar_t'.
+\remarks The cursor and selection positions are indices of code units, but cursor movement and character removal
+always operate on entire characters (i.e. code points).
+*/
+template <typename T>
+class BasicTextField
 {
 
     public:
 
+        //! Character type alias.
+        using CharType = T;
+
+        //! String type alias.
+        using StringType = std::basic_string<T>;
+
         //! String size type alias.
-        using SizeType = String::size_type;
+        using SizeType = typename StringType::size_type;
 
-        virtual ~TextField();
+        virtual ~BasicTextField();
 
         /* --- Cursor operations --- */
 
@@ -48,7 +60,7 @@ class TextField
         //! Returns true if the cursor is at the end.
         bool IsCursorEnd() const;
 
-        //! Moves the cursor into the specified direction.
+        //! Moves the cursor into the specified direction (in characters, i.e. code points).
         virtual void MoveCursor(int direction) = 0;
 
         //! Jumps to the next left sided space.
@@ -103,7 +115,7 @@ class TextField
         bool IsAllSelected() const;
 
         //! Returns the selected text.
-        String GetSelectionText() const;
+        StringType GetSelectionText() const;
 
         /* --- String content --- */
 
@@ -111,13 +123,13 @@ class TextField
         Returns the current character which stands immediately before the cursor position.
         If the cursor is at the very beginning of the text field, the return value is '\0'.
         */
-        virtual Char CharLeft() const = 0;
+        virtual T CharLeft() const = 0;
 
         /**
         Returns the current character which stands immediately after the cursor position.
         If the cursor is at the very end of the text field, the return value is '\0'.
         */
-        virtual Char CharRight() const = 0;
+        virtual T CharRight() const = 0;
 
         //! Removes the character on the left of the current cursor position.
         virtual void RemoveLeft() = 0;
@@ -151,7 +163,16 @@ class TextField
         \see insertionEnabled
         \see RemoveSelection
         */
-        virtual void Insert(Char chr);
+        virtual void Insert(T chr);
+
+        /**
+        \brief Inserts the specified text at the current cursor position or replaces the current selection.
+        \remarks Invalid characters are ignored (see IsValidChar). In contrast to inserting each character separately,
+        the text content is only updated once.
+        \see insertionEnabled
+        \see Insert(T)
+        */
+        virtual void Insert(const StringType& text);
 
         /**
         \brief Inserts the specified character with some exceptions.
@@ -160,29 +181,33 @@ class TextField
         - char(127) which will remove all characters before the cursor until the next separator appears.
         \see Insert
         */
-        virtual void Put(Char chr);
+        virtual void Put(T chr);
 
-        //! Inserts the specified text.
-        virtual void Put(const String& text);
+        /**
+        \brief Inserts the specified text with the same exceptions as Put(T).
+        \remarks All characters between the special characters are inserted at once.
+        \see Insert(const StringType&)
+        */
+        virtual void Put(const StringType& text);
 
         //! Sets the content of the text field and clamps the cursor position.
-        virtual void SetText(const String& text) = 0;
+        virtual void SetText(const StringType& text) = 0;
 
         //! Returns the content of the text field.
-        virtual const String& GetText() const = 0;
+        virtual const StringType& GetText() const = 0;
 
         /**
         \brief Clears this text field
         \remarks The default implementation is equivalent to:
         \code
-        SetText("");
+        SetText(StringType());
         \endcode
         \see SetText
         */
         virtual void Clear();
 
         //! Returns true if the specified character is valid. By default 'chr' must be in the range [32, +inf).
-        virtual bool IsValidChar(Char chr) const = 0;
+        virtual bool IsValidChar(T chr) const = 0;
 
         /**
         \brief Returns true if the specified character is a separator.
@@ -190,7 +215,7 @@ class TextField
         \see JumpLeft
         \see JumpRight
         */
-        virtual bool IsSeparator(Char chr) const;
+        virtual bool IsSeparator(T chr) const;
 
         /* --- Memento --- */
 
@@ -252,12 +277,23 @@ class TextField
         //! Updates the cursor- and selection start position to the range [0, GetText().size()].
         void UpdateCursorRange();
 
+        //! Moves the cursor- and selection start position to the front, after the specified number of code units have been erased from the front of the text.
+        void ShiftCursorRange(SizeType length);
+
         /**
         \brief Inserts the specified character at the current cursor position.
         \remarks This is called by the "TextField::Insert" function.
         \see Insert
         */
-        virtual void InsertChar(Char chr, bool wasSelected) = 0;
+        virtual void InsertChar(T chr, bool wasSelected) = 0;
+
+        /**
+        \brief Inserts the specified text at the current cursor position and moves the cursor to the end of the new text.
+        \remarks This is called by the "TextField::Insert(const StringType&)" function with valid characters only.
+        The default implementation inserts each character separately with InsertChar.
+        \see Insert(const StringType&)
+        */
+        virtual void InsertText(const StringType& text, bool wasSelected);
 
     private:
 
@@ -269,7 +305,7 @@ class TextField
         struct MementoState
         {
             SizeType    cursorPos;
-            std::string text;
+            StringType  text;
         };
 
         using MementoStateList = std::list<MementoState>;
@@ -277,12 +313,23 @@ class TextField
         //! Returns the specified position, clamped to the range [0, GetText().size()].
         SizeType ClampedPos(SizeType pos) const;
 
+        //! Returns the beginning of the character sequence on the left of the specified position (see JumpLeft), and the number of characters in between.
+        SizeType FindSequenceLeft(SizeType pos, int& numChars) const;
+
+        //! Returns the end of the character sequence on the right of the specified position (see JumpRight), and the number of characters in between.
+        SizeType FindSequenceRight(SizeType pos, int& numChars) const;
+
+        //! Removes the characters in the range [start, end) with a single call to RemoveSelection.
+        void RemoveRange(SizeType start, SizeType end);
+
         //! Restores the specified memento state.
         void RestoreMemento(std::size_t index);
 
-        MementoStateList::const_iterator GetMementoStateIter(std::size_t index) const;
+        typename MementoStateList::const_iterator GetMementoStateIter(std::size_t index) const;
 
-        void StoreMementoForChar(Char chr);
+        void StoreMementoForChar(T chr);
+
+        void StoreMementoForText(const StringType& text);
 
         /* === Members === */
 
@@ -296,11 +343,20 @@ class TextField
         std::size_t                 mementoStatesIndex_ = 0;
         bool                        mementoExpired_     = false;
 
-        Char                        prevPutChar_        = 0;
+        T                           prevPutChar_        = 0;
 
 };
 
 
+extern template class BasicTextField<char>;
+extern template class BasicTextField<char16_t>;
+extern template class BasicTextField<char32_t>;
+extern template class BasicTextField<wchar_t>;
+
+//! Text field base class with the default character type (see Tg::Char).
+using TextField = BasicTextField<Char>;
+
+
 } // /namespace Tg
 
 
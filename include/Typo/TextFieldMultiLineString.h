@@ -20,22 +20,28 @@ namespace Tg
 
 /**
 \brief Text field multi-line string class.
+\tparam T Specifies the character type (see BasicTextField).
 \remarks In a model-view-controller pattern, this is the model for a user input text field.
 */
-class TextFieldMultiLineString : public TextField
+template <typename T>
+class BasicTextFieldMultiLineString : public BasicTextField<T>
 {
 
     public:
 
-        TextFieldMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const String& text);
+        using StringType    = typename BasicTextField<T>::StringType;
+        using SizeType      = typename BasicTextField<T>::SizeType;
+        using TextLine      = typename BasicMultiLineString<T>::TextLine;
 
-        TextFieldMultiLineString& operator = (const String& str);
+        BasicTextFieldMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const StringType& text);
 
-        TextFieldMultiLineString& operator += (const String& str);
+        BasicTextFieldMultiLineString& operator = (const StringType& str);
 
-        TextFieldMultiLineString& operator += (Char chr);
+        BasicTextFieldMultiLineString& operator += (const StringType& str);
 
-        inline operator const String& () const
+        BasicTextFieldMultiLineString& operator += (T chr);
+
+        inline operator const StringType& () const
         {
             return text_;
         }
@@ -70,6 +76,16 @@ class TextFieldMultiLineString : public TextField
         */
         SizeType GetXCoordinateFromPosition(SizeType positionX, std::size_t lineIndex) const;
 
+        /**
+        \brief Returns the text index, which is closest to the specified point (e.g. a mouse position).
+        \param[in] x Specifies the X coordinate (in pixels) relative to the text field.
+        \param[in] y Specifies the Y coordinate (in pixels) relative to the text field.
+        \param[in] lineHeight Specifies the height of each line (in pixels).
+        \remarks This can be used in conjunction with functions like "SetCursorPosition" and "SetSelection".
+        \see MultiLineString::HitTest
+        */
+        SizeType HitTest(int x, int y, int lineHeight) const;
+
         /* --- Cursor operations --- */
 
         //! Sets the new cursor XY coordinate. This will be clamped to the range [0, GetText().size()] for X and [0, GetLines().size()) for Y.
@@ -80,7 +96,10 @@ class TextFieldMultiLineString : public TextField
             SetCursorCoordinate({ positionX, positionY });
         }
 
-        //! Returns the current cursor XY coordinate. This is always in the range [0, GetText().size()] for X and [0, GetLines().size()) for Y.
+        /**
+        \brief Returns the current cursor XY coordinate. This is always in the range [0, GetText().size()] for X and [0, GetLines().size()) for Y.
+        \remarks The coordinate is cached for the cursor position and the layout version (see MultiLineString::GetLayoutVersion).
+        */
         Point GetCursorCoordinate() const;
 
         //! Returns true if the cursor Y position is at the top.
@@ -127,13 +146,13 @@ class TextFieldMultiLineString : public TextField
         Returns the current character which stands immediately before the cursor X position.
         If the cursor is at the very beginning of the text field, the return value is '\0'.
         */
-        Char CharLeft() const override;
+        T CharLeft() const override;
 
         /**
         Returns the current character which stands immediately after the cursor X position.
         If the cursor is at the very end of the text field, the return value is '\0'.
         */
-        Char CharRight() const override;
+        T CharRight() const override;
 
         //! Removes the character on the left of the current cursor position.
         void RemoveLeft() override;
@@ -148,7 +167,7 @@ class TextFieldMultiLineString : public TextField
         void RemoveSelection() override;
 
         //! Returns true if the specified character is valid. By default 'chr' must be in the range [32, +inf).
-        bool IsValidChar(Char chr) const override;
+        bool IsValidChar(T chr) const override;
 
         //! \see MultiLineString::SetGlyphSet
         inline void SetGlyphSet(const FontGlyphSet& glyphSet)
@@ -178,28 +197,53 @@ class TextFieldMultiLineString : public TextField
         }
 
         //! Sets the content of the text field and clamps the cursor position.
-        void SetText(const String& text) override;
+        void SetText(const StringType& text) override;
 
         //! \see MultiLineString::GetText
-        const String& GetText() const override;
+        const StringType& GetText() const override;
+
+        /**
+        \brief Erases whole paragraphs from the front and moves the cursor and selection accordingly.
+        \return Number of code units which have been erased.
+        \see MultiLineString::TrimFront
+        */
+        SizeType TrimFront(SizeType maxLines, SizeType maxLength);
 
         //! \see MultiLineString::GetLines
-        inline const std::vector<MultiLineString::TextLine>& GetLines() const
+        inline const std::vector<TextLine>& GetLines() const
         {
             return text_.GetLines();
         }
 
+        //! \see MultiLineString::SetAttribute
+        inline void SetAttribute(const TextAttribute& attribute)
+        {
+            text_.SetAttribute(attribute);
+        }
+
+        //! \see MultiLineString::GetAttribute
+        inline const TextAttribute& GetAttribute() const
+        {
+            return text_.GetAttribute();
+        }
+
+        //! \see MultiLineString::GetAttributeSpans
+        inline const std::vector<TextAttributeSpan>& GetAttributeSpans() const
+        {
+            return text_.GetAttributeSpans();
+        }
+
         //! Returns the current line (where the cursor is located.
-        const MultiLineString::TextLine& GetLine() const;
+        const TextLine& GetLine() const;
 
         //! Returns the specified line.
-        const MultiLineString::TextLine& GetLine(std::size_t lineIndex) const;
+        const TextLine& GetLine(std::size_t lineIndex) const;
 
         //! Returns the content of the current line (where the cursor is located).
-        const String& GetLineText() const;
+        const StringType& GetLineText() const;
 
         //! Returns the content of the specified line.
-        const String& GetLineText(std::size_t lineIndex) const;
+        const StringType& GetLineText(std::size_t lineIndex) const;
 
         /* === Members === */
 
@@ -208,7 +252,20 @@ class TextFieldMultiLineString : public TextField
 
     private:
 
-        void InsertChar(Char chr, bool wasSelected) override;
+        //! Cursor coordinate, which is cached for a cursor position and layout version.
+        struct CursorCache
+        {
+            SizeType    position        = 0;
+            std::size_t layoutVersion   = 0;
+            Point       coord;
+            SizeType    coordX          = 0;        // Cursor X coordinate in pixels (see GetXCoordinateFromPosition)
+            bool        hasCoordX       = false;    // Specifies whether 'coordX' is up-to-date
+            bool        valid           = false;
+        };
+
+        void InsertChar(T chr, bool wasSelected) override;
+
+        void InsertText(const StringType& text, bool wasSelected) override;
 
         /**
         \brief Returns true if the line above the cursor is empty (also true if the cursor is at the top).
@@ -228,15 +285,35 @@ class TextFieldMultiLineString : public TextField
         //! Restores the previous cursor coordinate X (uses GetXPositionFromCoordinate) at the specified Y coordinate.
         void RestoreCursorCoordX(SizeType lineIndex);
 
+        /**
+        \brief Returns the cursor cache, after it has been updated for the current cursor position and layout version.
+        \remarks The previous cursor line and its neighbors are checked first, so moving the cursor is O(1) in most cases.
+        */
+        CursorCache& GetCursorCache() const;
+
+        //! Returns true if the specified text index is located in the specified line, i.e. GetTextPosition would return this line.
+        bool IsIndexInLine(SizeType index, SizeType lineIndex) const;
+
         /* === Member === */
 
-        MultiLineString text_;
+        BasicMultiLineString<T> text_;
+
+        SizeType                storedCursorCoordX_ = 0;
 
-        SizeType        storedCursorCoordX_ = 0;
+        mutable CursorCache     cursorCache_;
 
 };
 
 
+extern template class BasicTextFieldMultiLineString<char>;
+extern template class BasicTextFieldMultiLineString<char16_t>;
+extern template class BasicTextFieldMultiLineString<char32_t>;
+extern template class BasicTextFieldMultiLineString<wchar_t>;
+
+//! Text field multi-line string with the default character type (see Tg::Char).
+using TextFieldMultiLineString = BasicTextFieldMultiLineString<Char>;
+
+
 } // /namespace Tg
 
 
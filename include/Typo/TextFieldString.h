@@ -10,6 +10,7 @@
 
 
 #include "TextField.h"
+#include "Unicode.h"
 
 
 namespace Tg
@@ -18,24 +19,29 @@ namespace Tg
 
 /**
 \brief Text field string class.
+\tparam T Specifies the character type (see BasicTextField).
 \remarks In a model-view-controller pattern, this is the model for a user input text field.
 */
-class TextFieldString : public TextField
+template <typename T>
+class BasicTextFieldString : public BasicTextField<T>
 {
 
     public:
 
-        TextFieldString() = default;
+        using StringType    = typename BasicTextField<T>::StringType;
+        using SizeType      = typename BasicTextField<T>::SizeType;
 
-        TextFieldString(const String& str);
+        BasicTextFieldString() = default;
 
-        TextFieldString& operator = (const String& str);
+        BasicTextFieldString(const StringType& str);
 
-        TextFieldString& operator += (const String& str);
+        BasicTextFieldString& operator = (const StringType& str);
 
-        TextFieldString& operator += (const Char& chr);
+        BasicTextFieldString& operator += (const StringType& str);
 
-        inline operator const String& () const
+        BasicTextFieldString& operator += (const T& chr);
+
+        inline operator const StringType& () const
         {
             return text_;
         }
@@ -57,13 +63,13 @@ class TextFieldString : public TextField
         Returns the current character which stands immediately before the cursor position.
         If the cursor is at the very beginning of the text field, the return value is '\0'.
         */
-        Char CharLeft() const override;
+        T CharLeft() const override;
 
         /**
         Returns the current character which stands immediately after the cursor position.
         If the cursor is at the very end of the text field, the return value is '\0'.
         */
-        Char CharRight() const override;
+        T CharRight() const override;
 
         //! Removes the character on the left of the current cursor position.
         void RemoveLeft() override;
@@ -78,13 +84,13 @@ class TextFieldString : public TextField
         void RemoveSelection() override;
 
         //! Returns true if the specified character is valid. By default 'chr' must be in the range [32, +inf).
-        bool IsValidChar(Char chr) const override;
+        bool IsValidChar(T chr) const override;
 
         //! Sets the content of the text field and clamps the cursor position.
-        void SetText(const String& text) override;
+        void SetText(const StringType& text) override;
 
         //! Returns the content of the text field.
-        const String& GetText() const override;
+        const StringType& GetText() const override;
 
         /* === Members === */
 
@@ -93,21 +99,32 @@ class TextFieldString : public TextField
 
     private:
 
-        void InsertChar(Char chr, bool wasSelected) override;
+        void InsertChar(T chr, bool wasSelected) override;
+
+        void InsertText(const StringType& text, bool wasSelected) override;
 
         //! Returns the iterator to the string at the specified cursor position.
-        String::iterator Iter();
+        typename StringType::iterator Iter();
 
         //! Returns the constant iterator to the string at the specified cursor position.
-        String::const_iterator Iter() const;
+        typename StringType::const_iterator Iter() const;
 
         /* === Member === */
 
-        String text_;
+        StringType text_;
 
 };
 
 
+extern template class BasicTextFieldString<char>;
+extern template class BasicTextFieldString<char16_t>;
+extern template class BasicTextFieldString<char32_t>;
+extern template class BasicTextFieldString<wchar_t>;
+
+//! Text field string with the default character type (see Tg::Char).
+using TextFieldString = BasicTextFieldString<Char>;
+
+
 } // /namespace Tg
 
 
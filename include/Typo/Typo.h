@@ -11,10 +11,13 @@
 
 #include "Font.h"
 #include "MultiLineString.h"
+#include "LazyMultiLineString.h"
 #include "TextFieldString.h"
 #include "TextFieldMultiLineString.h"
 #include "SystemFontPath.h"
 #include "Terminal.h"
+#include "TerminalGrid.h"
+#include "Unicode.h"
 
 
 #endif
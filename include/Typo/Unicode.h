@@ -0,0 +1,199 @@
+/*
+ * Unicode.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_UNICODE_H
+#define TG_UNICODE_H
+
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Tg
+{
+
+
+/**
+\brief Returns the number of code units of the UTF-8 sequence, which begins with the specified lead byte.
+\remarks Continuation bytes and invalid lead bytes have a length of 1.
+*/
+inline std::size_t UTF8SequenceLength(unsigned char lead)
+{
+    static const unsigned char lengths[32] =
+    {
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xxxxxxx
+        1, 1, 1, 1, 1, 1, 1, 1,                         // 10xxxxxx
+        2, 2, 2, 2,                                     // 110xxxxx
+        3, 3,                                           // 1110xxxx
+        4,                                              // 11110xxx
+        1,                                              // 11111xxx
+    };
+    return lengths[lead >> 3];
+}
+
+//! Returns true if the specified code unit can not start a character, i.e. it is a UTF-8 continuation byte.
+inline bool IsContinuationUnit(char chr)
+{
+    return ((static_cast<unsigned char>(chr) & 0xC0) == 0x80);
+}
+
+//! Returns true if the specified code unit can not start a character, i.e. it is a UTF-16 low surrogate.
+inline bool IsContinuationUnit(char16_t chr)
+{
+    return ((chr & 0xFC00) == 0xDC00);
+}
+
+//! Returns always false, since UTF-32 code units are always complete characters.
+inline bool IsContinuationUnit(char32_t /*chr*/)
+{
+    return false;
+}
+
+//! Returns true if the specified code unit can not start a character, i.e. it is a UTF-16 low surrogate (only if 'wchar_t' has 16 bits).
+inline bool IsContinuationUnit(wchar_t chr)
+{
+    return (sizeof(wchar_t) == 2 && (static_cast<std::uint32_t>(chr) & 0xFC00) == 0xDC00);
+}
+
+/**
+\brief Decodes the UTF-8 encoded character at the specified position and moves the position to the next character.
+\param[in] str Pointer to the UTF-8 string.
+\param[in] size Specifies the number of code units in the string.
+\param[in,out] pos Specifies the position of the character. This must be less than 'size'.
+\remarks Invalid sequences are decoded byte by byte as Latin-1 characters,
+so that plain 8-bit strings are still decoded as they were before.
+*/
+inline char32_t DecodeCodePoint(const char* str, std::size_t size, std::size_t& pos)
+{
+    static const unsigned char  leadMasks[5]    = { 0, 0x7F, 0x1F, 0x0F, 0x07 };
+    static const char32_t       minValues[5]    = { 0, 0, 0x80, 0x800, 0x10000 };
+
+    auto s = reinterpret_cast<const unsigned char*>(str) + pos;
+    auto len = UTF8SequenceLength(s[0]);
+
+    if (len > 1 && len <= size - pos)
+    {
+        /* Accumulate payload bits and validate all continuation bytes at once */
+        char32_t chr = (s[0] & leadMasks[len]);
+        unsigned int invalid = 0;
+
+        for (std::size_t i = 1; i < len; ++i)
+        {
+            chr = (chr << 6) | (s[i] & 0x3F);
+            invalid |= ((s[i] & 0xC0) ^ 0x80);
+        }
+
+        /* Reject overlong encodings, surrogates, and code points beyond U+10FFFF */
+        if (!invalid && chr >= minValues[len] && chr <= 0x10FFFF && (chr & 0xFFFFF800) != 0xD800)
+        {
+            pos += len;
+            return chr;
+        }
+    }
+
+    ++pos;
+    return s[0];
+}
+
+/**
+\brief Decodes the UTF-16 encoded character at the specified position and moves the position to the next character.
+\remarks Unpaired surrogates are decoded as they are.
+*/
+inline char32_t DecodeCodePoint(const char16_t* str, std::size_t size, std::size_t& pos)
+{
+    char32_t chr = str[pos++];
+
+    if ((chr & 0xFC00) == 0xD800 && pos < size && IsContinuationUnit(str[pos]))
+        chr = 0x10000 + ((chr - 0xD800) << 10) + (static_cast<char32_t>(str[pos++]) - 0xDC00);
+
+    return chr;
+}
+
+//! Returns the UTF-32 encoded character at the specified position and moves the position to the next character.
+inline char32_t DecodeCodePoint(const char32_t* str, std::size_t /*size*/, std::size_t& pos)
+{
+    return str[pos++];
+}
+
+/**
+\brief Decodes the wide character at the specified position and moves the position to the next character.
+\remarks If 'wchar_t' has 16 bits, surrogate pairs are decoded as UTF-16.
+*/
+inline char32_t DecodeCodePoint(const wchar_t* str, std::size_t size, std::size_t& pos)
+{
+    auto chr = static_cast<char32_t>(str[pos++]);
+
+    if (sizeof(wchar_t) == 2)
+    {
+        chr &= 0xFFFF;
+        if ((chr & 0xFC00) == 0xD800 && pos < size && IsContinuationUnit(str[pos]))
+            chr = 0x10000 + ((chr - 0xD800) << 10) + ((static_cast<char32_t>(str[pos++]) & 0xFFFF) - 0xDC00);
+    }
+
+    return chr;
+}
+
+//! \see DecodeCodePoint(const char*, std::size_t, std::size_t&)
+template <typename T>
+char32_t DecodeCodePoint(const std::basic_string<T>& str, std::size_t& pos)
+{
+    return DecodeCodePoint(str.data(), str.size(), pos);
+}
+
+//! Returns the position of the character after the character at the specified position. The position is clamped to the range [0, str.size()].
+template <typename T>
+std::size_t NextCodePoint(const std::basic_string<T>& str, std::size_t pos)
+{
+    if (pos < str.size())
+        DecodeCodePoint(str, pos);
+    else
+        pos = str.size();
+    return pos;
+}
+
+//! Returns the position of the character before the specified position. The position is clamped to the range [0, str.size()].
+template <typename T>
+std::size_t PrevCodePoint(const std::basic_string<T>& str, std::size_t pos)
+{
+    if (pos > str.size())
+        return str.size();
+    if (pos == 0)
+        return 0;
+
+    /* Move back over all continuation units (at most 3), and check if the sequence ends at the input position */
+    auto start = pos - 1;
+    while (start > 0 && pos - start < 4 && IsContinuationUnit(str[start]))
+        --start;
+
+    if (NextCodePoint(str, start) == pos)
+        return start;
+
+    return pos - 1;
+}
+
+//! Returns the number of characters (i.e. code points) in the specified string.
+template <typename T>
+std::size_t CodePointCount(const std::basic_string<T>& str)
+{
+    std::size_t count = 0;
+
+    for (std::size_t pos = 0; pos < str.size(); ++count)
+        DecodeCodePoint(str, pos);
+
+    return count;
+}
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
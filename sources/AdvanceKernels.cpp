@@ -0,0 +1,168 @@
+/*
+ * AdvanceKernels.cpp
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "AdvanceKernels.h"
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define TG_ADVANCE_KERNELS_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define TG_ADVANCE_KERNELS_SSE2
+#endif
+
+
+namespace Tg
+{
+
+
+#ifdef TG_ADVANCE_KERNELS_AVX2
+
+// Gathers the advances of 8 characters into 32-bit lanes
+static inline __m256i GatherAdvances8(const int* table, const std::uint8_t* text)
+{
+    auto indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(text)));
+    return _mm256_i32gather_epi32(table, indices, 4);
+}
+
+// Returns the sum of all eight 32-bit lanes
+static inline int HorizontalSum8(__m256i v)
+{
+    auto sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+#endif
+
+int SumAdvances(const int* table, const std::uint8_t* text, std::size_t len)
+{
+    std::size_t i = 0;
+    int width = 0;
+
+    #ifdef TG_ADVANCE_KERNELS_AVX2
+
+    /* Accumulate 32 characters per iteration with four independent gathers */
+    auto acc0 = _mm256_setzero_si256();
+    auto acc1 = _mm256_setzero_si256();
+
+    for (; i + 32 <= len; i += 32)
+    {
+        acc0 = _mm256_add_epi32(acc0, GatherAdvances8(table, text + i     ));
+        acc1 = _mm256_add_epi32(acc1, GatherAdvances8(table, text + i +  8));
+        acc0 = _mm256_add_epi32(acc0, GatherAdvances8(table, text + i + 16));
+        acc1 = _mm256_add_epi32(acc1, GatherAdvances8(table, text + i + 24));
+    }
+
+    for (; i + 8 <= len; i += 8)
+        acc0 = _mm256_add_epi32(acc0, GatherAdvances8(table, text + i));
+
+    width = HorizontalSum8(_mm256_add_epi32(acc0, acc1));
+
+    #else
+
+    /* Accumulate 4 characters per iteration with independent accumulators */
+    int w0 = 0, w1 = 0, w2 = 0, w3 = 0;
+
+    for (; i + 4 <= len; i += 4)
+    {
+        w0 += table[text[i    ]];
+        w1 += table[text[i + 1]];
+        w2 += table[text[i + 2]];
+        w3 += table[text[i + 3]];
+    }
+
+    width = (w0 + w1) + (w2 + w3);
+
+    #endif
+
+    /* Accumulate remaining characters */
+    for (; i < len; ++i)
+        width += table[text[i]];
+
+    return width;
+}
+
+std::size_t FitAdvances(const int* table, const std::uint8_t* text, std::size_t len, int maxWidth, int& width)
+{
+    std::size_t i = 0;
+    width = 0;
+
+    #ifdef TG_ADVANCE_KERNELS_AVX2
+
+    /* Skip entire blocks of 8 characters as long as they fit */
+    for (; i + 8 <= len; i += 8)
+    {
+        auto blockWidth = HorizontalSum8(GatherAdvances8(table, text + i));
+        if (width + blockWidth > maxWidth)
+            break;
+        width += blockWidth;
+    }
+
+    #else
+
+    /* Skip entire blocks of 4 characters as long as they fit */
+    for (; i + 4 <= len; i += 4)
+    {
+        auto blockWidth = table[text[i]] + table[text[i + 1]] + table[text[i + 2]] + table[text[i + 3]];
+        if (width + blockWidth > maxWidth)
+            break;
+        width += blockWidth;
+    }
+
+    #endif
+
+    /* Find the exact position within the last block */
+    for (; i < len; ++i)
+    {
+        auto advance = table[text[i]];
+        if (width + advance > maxWidth)
+            break;
+        width += advance;
+    }
+
+    return i;
+}
+
+std::size_t ASCIIRunLength(const std::uint8_t* text, std::size_t len)
+{
+    std::size_t i = 0;
+
+    #ifdef TG_ADVANCE_KERNELS_SSE2
+
+    /* Test the high bit of 16 bytes per iteration */
+    for (; i + 16 <= len; i += 16)
+    {
+        auto mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)));
+        if (mask != 0)
+        {
+            while ((mask & 1) == 0)
+            {
+                mask >>= 1;
+                ++i;
+            }
+            return i;
+        }
+    }
+
+    #endif
+
+    while (i < len && text[i] < 0x80)
+        ++i;
+
+    return i;
+}
+
+
+} // /namespace Tg
+
+
+
+// ================================================================================
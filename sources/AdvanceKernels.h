@@ -0,0 +1,49 @@
+/*
+ * AdvanceKernels.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_ADVANCE_KERNELS_H
+#define TG_ADVANCE_KERNELS_H
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Tg
+{
+
+
+/**
+\brief Returns the sum of all glyph advances of the specified 8-bit characters.
+\param[in] table Pointer to the 256-entry advance table (see FontGlyphSet::UpdateAdvanceTable).
+\param[in] text Pointer to the 8-bit characters.
+\param[in] len Specifies the number of characters.
+*/
+int SumAdvances(const int* table, const std::uint8_t* text, std::size_t len);
+
+/**
+\brief Returns the number of leading characters whose accumulated advance does not exceed 'maxWidth'.
+\param[in] table Pointer to the 256-entry advance table (see FontGlyphSet::UpdateAdvanceTable).
+\param[in] text Pointer to the 8-bit characters.
+\param[in] len Specifies the number of characters.
+\param[in] maxWidth Specifies the maximal accumulated advance.
+\param[out] width Specifies the accumulated advance of all characters that fit into 'maxWidth'.
+*/
+std::size_t FitAdvances(const int* table, const std::uint8_t* text, std::size_t len, int maxWidth, int& width);
+
+//! Returns the length of the leading run of ASCII characters (i.e. bytes in the range [0, 127]).
+std::size_t ASCIIRunLength(const std::uint8_t* text, std::size_t len);
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
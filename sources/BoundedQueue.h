@@ -0,0 +1,138 @@
+/*
+ * BoundedQueue.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_BOUNDED_QUEUE_H
+#define TG_BOUNDED_QUEUE_H
+
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+
+namespace Tg
+{
+
+
+/**
+\brief Lock-free bounded queue for multiple producers and a single consumer.
+\remarks Each cell stores a sequence number, which tells whether the cell is free for the producer of a position,
+or ready for the consumer of a position. Producers only compete for the enqueue position (with a CAS loop),
+and never wait for each other or for the consumer. If the queue is full, TryPush fails immediately.
+*/
+template <typename T>
+class BoundedQueue
+{
+
+    public:
+
+        //! Constructs the queue with the specified capacity, which is rounded up to the next power of two.
+        explicit BoundedQueue(std::size_t capacity)
+        {
+            std::size_t size = 2;
+            while (size < capacity)
+                size *= 2;
+
+            cells_.reset(new Cell[size]);
+            mask_ = size - 1;
+
+            for (std::size_t i = 0; i < size; ++i)
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator = (const BoundedQueue&) = delete;
+
+        //! Returns the capacity of this queue.
+        std::size_t Capacity() const
+        {
+            return (mask_ + 1);
+        }
+
+        /**
+        \brief Pushes the specified value into the queue. This can be called from any thread.
+        \return True on success, or false if the queue is full. In this case, 'value' is not moved.
+        */
+        bool TryPush(T&& value)
+        {
+            auto pos = enqueuePos_.load(std::memory_order_relaxed);
+            Cell* cell = nullptr;
+
+            while (true)
+            {
+                cell = &cells_[pos & mask_];
+                auto seq = cell->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+
+                if (diff == 0)
+                {
+                    /* Cell is free -> try to reserve this position */
+                    if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    /* Cell still holds the value of the previous round -> queue is full */
+                    return false;
+                }
+                else
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+
+            /* Store value and publish it to the consumer */
+            cell->value = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+        \brief Pops the next value from the queue. This must only be called from the consumer thread.
+        \return True on success, or false if the queue is empty (or the next value is not yet published).
+        */
+        bool TryPop(T& value)
+        {
+            auto& cell = cells_[dequeuePos_ & mask_];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1)
+                return false;
+
+            /* Take value and release the cell for the next round */
+            value = std::move(cell.value);
+            cell.sequence.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+            ++dequeuePos_;
+
+            return true;
+        }
+
+    private:
+
+        struct Cell
+        {
+            std::atomic<std::size_t>    sequence;
+            T                           value;
+        };
+
+        std::unique_ptr<Cell[]>     cells_;
+        std::size_t                 mask_       = 0;
+
+        // Padding to keep the producer and consumer positions in different cache lines
+        char                        padding0_[64];
+        std::atomic<std::size_t>    enqueuePos_ { 0 };
+        char                        padding1_[64];
+        std::size_t                 dequeuePos_ = 0;
+
+};
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
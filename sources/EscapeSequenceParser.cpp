@@ -0,0 +1,284 @@
+/*
+ * EscapeSequenceParser.cpp
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "EscapeSequenceParser.h"
+
+
+namespace Tg
+{
+
+
+void EscapeSequenceParser::Parse(const char* text, std::size_t length, EscapeSequenceHandler& handler)
+{
+    /* Begin of the current text run */
+    std::size_t start = 0;
+
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        auto chr = text[i];
+
+        switch (state_)
+        {
+            case State::Ground:
+            {
+                if (chr == '\x1B' || chr == '\r')
+                {
+                    /* Pass text run before the control character */
+                    if (start < i)
+                        handler.OnText(text + start, i - start);
+
+                    if (chr == '\r')
+                        handler.OnCarriageReturn();
+                    else
+                        state_ = State::Escape;
+
+                    start = i + 1;
+                }
+            }
+            break;
+
+            case State::Escape:
+            {
+                if (chr == '[')
+                    BeginControlSequence();
+                else if (chr == ']' || chr == 'P' || chr == 'X' || chr == '^' || chr == '_')
+                    state_ = State::String;
+                else if (chr >= 0x20 && chr <= 0x2F)
+                    state_ = State::EscapeIntermediate;
+                else
+                    state_ = State::Ground;
+                start = i + 1;
+            }
+            break;
+
+            case State::EscapeIntermediate:
+            {
+                if (chr >= 0x30 && chr <= 0x7E)
+                    state_ = State::Ground;
+                start = i + 1;
+            }
+            break;
+
+            case State::ControlSequence:
+            {
+                if (chr >= '0' && chr <= '9')
+                {
+                    /* Accumulate digit (large values are clamped) */
+                    if (param_ < 100000)
+                        param_ = param_ * 10 + (chr - '0');
+                    hasParam_ = true;
+                }
+                else if (chr == ';' || chr == ':')
+                {
+                    if (numParams_ < maxParams)
+                        params_[numParams_++] = param_;
+                    param_ = 0;
+                    hasParam_ = true;
+                }
+                else if (chr >= 0x3C && chr <= 0x3F)
+                {
+                    /* Private sequence, e.g. "ESC[?25l" */
+                    ignoreSequence_ = true;
+                }
+                else if (chr >= 0x20 && chr <= 0x2F)
+                {
+                    /* Intermediate character */
+                    ignoreSequence_ = true;
+                }
+                else if (chr >= 0x40 && chr <= 0x7E)
+                {
+                    EndControlSequence(chr, handler);
+                    state_ = State::Ground;
+                }
+                else if (chr == '\x1B')
+                {
+                    /* Abort sequence and begin a new one */
+                    state_ = State::Escape;
+                }
+                start = i + 1;
+            }
+            break;
+
+            case State::String:
+            {
+                /* Skip string until BEL or ST (i.e. "ESC\") */
+                if (chr == '\x07')
+                    state_ = State::Ground;
+                else if (chr == '\x1B')
+                    state_ = State::StringEscape;
+                start = i + 1;
+            }
+            break;
+
+            case State::StringEscape:
+            {
+                state_ = State::Ground;
+                start = i + 1;
+            }
+            break;
+        }
+    }
+
+    /* Pass remaining text run */
+    if (state_ == State::Ground && start < length)
+        handler.OnText(text + start, length - start);
+}
+
+void EscapeSequenceParser::Reset()
+{
+    state_ = State::Ground;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void EscapeSequenceParser::BeginControlSequence()
+{
+    state_          = State::ControlSequence;
+    numParams_      = 0;
+    param_          = 0;
+    hasParam_       = false;
+    ignoreSequence_ = false;
+}
+
+void EscapeSequenceParser::EndControlSequence(char command, EscapeSequenceHandler& handler)
+{
+    if (hasParam_ && numParams_ < maxParams)
+        params_[numParams_++] = param_;
+
+    if (!ignoreSequence_)
+        handler.OnControlSequence(command, params_, numParams_);
+}
+
+
+/*
+ * ======= Global functions: =======
+ */
+
+// Returns the RGB color of the specified index within the 256 color palette of xterm.
+static std::uint32_t PaletteColor(int index)
+{
+    static const std::uint32_t standardColors[16] =
+    {
+        0x000000, 0xCD0000, 0x00CD00, 0xCDCD00, 0x0000EE, 0xCD00CD, 0x00CDCD, 0xE5E5E5,
+        0x7F7F7F, 0xFF0000, 0x00FF00, 0xFFFF00, 0x5C5CFF, 0xFF00FF, 0x00FFFF, 0xFFFFFF,
+    };
+
+    if (index < 16)
+        return standardColors[index];
+
+    if (index < 232)
+    {
+        /* 6x6x6 color cube */
+        static const std::uint32_t levels[6] = { 0x00, 0x5F, 0x87, 0xAF, 0xD7, 0xFF };
+        index -= 16;
+        return (levels[index / 36] << 16) | (levels[(index / 6) % 6] << 8) | levels[index % 6];
+    }
+
+    /* Gray scale ramp */
+    auto gray = static_cast<std::uint32_t>(8 + 10 * ((index > 255 ? 255 : index) - 232));
+    return (gray << 16) | (gray << 8) | gray;
+}
+
+// Reads an extended color ("5;n" or "2;r;g;b") after parameter 'i', and moves 'i' to its last parameter.
+static bool ReadExtendedColor(const int* params, std::size_t numParams, std::size_t& i, std::uint32_t& color)
+{
+    if (i + 2 < numParams && params[i + 1] == 5)
+    {
+        color = PaletteColor(params[i + 2]);
+        i += 2;
+        return true;
+    }
+
+    if (i + 4 < numParams && params[i + 1] == 2)
+    {
+        auto Channel = [](int value)
+        {
+            return static_cast<std::uint32_t>(value > 255 ? 255 : value);
+        };
+        color = (Channel(params[i + 2]) << 16) | (Channel(params[i + 3]) << 8) | Channel(params[i + 4]);
+        i += 4;
+        return true;
+    }
+
+    /* Skip malformed parameters */
+    i = numParams;
+    return false;
+}
+
+void ApplySGR(TextAttribute& attribute, const int* params, std::size_t numParams)
+{
+    /* "ESC[m" is equivalent to "ESC[0m" */
+    if (numParams == 0)
+    {
+        attribute = TextAttribute();
+        return;
+    }
+
+    for (std::size_t i = 0; i < numParams; ++i)
+    {
+        auto param = params[i];
+
+        if (param == 0)
+            attribute = TextAttribute();
+        else if (param == 1)
+            attribute.flags |= TextAttributeFlags::Bold;
+        else if (param == 3)
+            attribute.flags |= TextAttributeFlags::Italic;
+        else if (param == 4)
+            attribute.flags |= TextAttributeFlags::Underlined;
+        else if (param == 7)
+            attribute.flags |= TextAttributeFlags::Inverse;
+        else if (param == 22)
+            attribute.flags &= ~TextAttributeFlags::Bold;
+        else if (param == 23)
+            attribute.flags &= ~TextAttributeFlags::Italic;
+        else if (param == 24)
+            attribute.flags &= ~TextAttributeFlags::Underlined;
+        else if (param == 27)
+            attribute.flags &= ~TextAttributeFlags::Inverse;
+        else if ((param >= 30 && param <= 37) || (param >= 90 && param <= 97))
+        {
+            attribute.foreground = PaletteColor(param >= 90 ? param - 90 + 8 : param - 30);
+            attribute.flags |= TextAttributeFlags::Foreground;
+        }
+        else if ((param >= 40 && param <= 47) || (param >= 100 && param <= 107))
+        {
+            attribute.background = PaletteColor(param >= 100 ? param - 100 + 8 : param - 40);
+            attribute.flags |= TextAttributeFlags::Background;
+        }
+        else if (param == 38)
+        {
+            if (ReadExtendedColor(params, numParams, i, attribute.foreground))
+                attribute.flags |= TextAttributeFlags::Foreground;
+        }
+        else if (param == 48)
+        {
+            if (ReadExtendedColor(params, numParams, i, attribute.background))
+                attribute.flags |= TextAttributeFlags::Background;
+        }
+        else if (param == 39)
+        {
+            attribute.foreground = 0;
+            attribute.flags &= ~TextAttributeFlags::Foreground;
+        }
+        else if (param == 49)
+        {
+            attribute.background = 0;
+            attribute.flags &= ~TextAttributeFlags::Background;
+        }
+    }
+}
+
+
+} // /namespace Tg
+
+
+
+// ================================================================================
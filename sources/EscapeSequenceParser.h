@@ -0,0 +1,106 @@
+/*
+ * EscapeSequenceParser.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_ESCAPE_SEQUENCE_PARSER_H
+#define TG_ESCAPE_SEQUENCE_PARSER_H
+
+
+#include <Typo/TextAttribute.h>
+#include <cstddef>
+
+
+namespace Tg
+{
+
+
+//! Interface for the output of the escape sequence parser.
+class EscapeSequenceHandler
+{
+
+    public:
+
+        virtual ~EscapeSequenceHandler()
+        {
+        }
+
+        //! Receives a run of characters without any escape sequences or carriage returns.
+        virtual void OnText(const char* text, std::size_t length) = 0;
+
+        //! Receives a carriage return, i.e. '\r'.
+        virtual void OnCarriageReturn() = 0;
+
+        /**
+        \brief Receives a control sequence (CSI), e.g. "ESC[1;31m".
+        \param[in] command Specifies the final character of the sequence, e.g. 'm' for SGR.
+        \param[in] params Specifies the numeric parameters. Omitted parameters are 0.
+        \param[in] numParams Specifies the number of parameters. This is 0 if the sequence has no parameters at all.
+        \remarks Private sequences (e.g. "ESC[?25l") and sequences with intermediate characters are ignored.
+        */
+        virtual void OnControlSequence(char command, const int* params, std::size_t numParams) = 0;
+
+};
+
+/**
+\brief Streaming parser for ANSI/VT escape sequences.
+\remarks The parser state is kept between calls to Parse, so sequences can be split across multiple calls.
+Control sequences (CSI) are passed to the handler, while all other escape sequences (e.g. OSC) are skipped.
+The parser does not allocate any memory.
+*/
+class EscapeSequenceParser
+{
+
+    public:
+
+        //! Parses the specified characters and passes the text runs and control sequences to the handler.
+        void Parse(const char* text, std::size_t length, EscapeSequenceHandler& handler);
+
+        //! Resets the parser state, i.e. discards any incomplete escape sequence.
+        void Reset();
+
+    private:
+
+        enum class State
+        {
+            Ground,             // Plain text
+            Escape,             // After ESC
+            EscapeIntermediate, // After ESC and an intermediate character, e.g. "ESC(B"
+            ControlSequence,    // After "ESC["
+            String,             // After "ESC]" (OSC), "ESCP" (DCS), etc. until BEL or ST
+            StringEscape,       // After ESC within a string
+        };
+
+        static const std::size_t maxParams = 16;
+
+        void BeginControlSequence();
+
+        void EndControlSequence(char command, EscapeSequenceHandler& handler);
+
+        State       state_              = State::Ground;
+
+        int         params_[maxParams];
+        std::size_t numParams_          = 0;
+        int         param_              = 0;
+        bool        hasParam_           = false;
+        bool        ignoreSequence_     = false;
+
+};
+
+/**
+\brief Applies the specified SGR (Select Graphic Rendition) parameters to the text attribute.
+\remarks This supports the 16 standard colors, the 256 color palette ("38;5;n"), and true colors ("38;2;r;g;b").
+*/
+void ApplySGR(TextAttribute& attribute, const int* params, std::size_t numParams);
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
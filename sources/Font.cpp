@@ -44,32 +44,24 @@ Font::~Font()
 {
 }
 
-template <typename T>
-int TextWidthTmpl(const FontGlyphSet& glyphSet, const std::basic_string<T>& text, std::size_t offset, std::size_t len)
+int Font::TextWidth(const std::string& text, std::size_t offset, std::size_t len) const
 {
-    /* Clamp text range */
-    if (offset > text.size())
-        offset = text.size();
-    if (len > text.size() - offset)
-        len = text.size() - offset;
-
-    /* Sum glyph widths */
-    int width = 0;
-
-    for (std::size_t i = 0; i < len; ++i)
-        width += glyphSet[text[offset + i]].advance;
+    return glyphSet_.TextWidth(text, offset, len);
+}
 
-    return width;
+int Font::TextWidth(const std::wstring& text, std::size_t offset, std::size_t len) const
+{
+    return glyphSet_.TextWidth(text, offset, len);
 }
 
-int Font::TextWidth(const std::string& text, std::size_t offset, std::size_t len) const
+int Font::TextWidth(const std::u16string& text, std::size_t offset, std::size_t len) const
 {
-    return TextWidthTmpl(glyphSet_, text, offset, len);
+    return glyphSet_.TextWidth(text, offset, len);
 }
 
-int Font::TextWidth(const std::wstring& text, std::size_t offset, std::size_t len) const
+int Font::TextWidth(const std::u32string& text, std::size_t offset, std::size_t len) const
 {
-    return TextWidthTmpl(glyphSet_, text, offset, len);
+    return glyphSet_.TextWidth(text, offset, len);
 }
 
 
@@ -281,6 +273,9 @@ UnpackedFontModel BuildUnpackedFont(const FontDescription& desc, const FontGlyph
     FT_Done_Face(face);
     FT_Done_FreeType(ftLib);
 
+    /* Update advance table for fast text measurement */
+    font.glyphSet.UpdateAdvanceTable();
+
     return font;
 }
 
@@ -358,6 +353,9 @@ FontModel BuildFont(const FontDescription& desc, const FontGlyphRange& glyphRang
         );
     }
 
+    /* Update advance table (it has been invalidated by the glyph tree) */
+    font.glyphSet.UpdateAdvanceTable();
+
     return font;
 }
 
@@ -417,14 +415,15 @@ Image PlotTextImage(const FontModel& fontModel, const String& text)
     /* Determine image size */
     const auto& glyphSet = fontModel.glyphSet;
 
-    auto xPos = std::max(0, -glyphSet[text[0]].xOffset);
+    std::size_t firstPos = 0;
+    auto xPos = std::max(0, -glyphSet[DecodeCodePoint(text, firstPos)].xOffset);
     auto width = static_cast<unsigned int>(xPos);
 
     int top = 0, bottom = 0, yOffsetMax = 0;
 
-    for (auto chr : text)
+    for (std::size_t pos = 0; pos < text.size();)
     {
-        const auto& glyph = fontModel.glyphSet[chr];
+        const auto& glyph = fontModel.glyphSet[DecodeCodePoint(text, pos)];
 
         width += glyph.advance;
         top = std::max(top, glyph.yOffset);
@@ -436,9 +435,9 @@ Image PlotTextImage(const FontModel& fontModel, const String& text)
     /* Plot each glyph into the image */
     Image image(Size(width + staticGlpyhBorder, top + bottom + staticGlpyhBorder));
 
-    for (auto chr : text)
+    for (std::size_t pos = 0; pos < text.size();)
     {
-        const auto& glyph = glyphSet[chr];
+        const auto& glyph = glyphSet[DecodeCodePoint(text, pos)];
 
         image.PlotImage(
             xPos + glyph.xOffset,
@@ -476,12 +475,13 @@ Image PlotMultiLineTextImage(const FontModel& fontModel, const String& text, uns
         if (line.text.empty())
             continue;
 
-        xPos = std::max(0, -glyphSet[line.text[0]].xOffset);
+        std::size_t firstPos = 0;
+        xPos = std::max(0, -glyphSet[DecodeCodePoint(line.text, firstPos)].xOffset);
         width = static_cast<unsigned int>(xPos);
 
-        for (auto chr : line.text)
+        for (std::size_t pos = 0; pos < line.text.size();)
         {
-            const auto& glyph = fontModel.glyphSet[chr];
+            const auto& glyph = fontModel.glyphSet[DecodeCodePoint(line.text, pos)];
 
             width += glyph.advance;
             top = std::max(top, glyph.yOffset);
@@ -504,9 +504,9 @@ Image PlotMultiLineTextImage(const FontModel& fontModel, const String& text, uns
     {
         xPos = xPosStart;
 
-        for (auto chr : line.text)
+        for (std::size_t pos = 0; pos < line.text.size();)
         {
-            const auto& glyph = glyphSet[chr];
+            const auto& glyph = glyphSet[DecodeCodePoint(line.text, pos)];
 
             image.PlotImage(
                 xPos + glyph.xOffset,
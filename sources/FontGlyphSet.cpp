@@ -6,6 +6,8 @@
  */
 
 #include <Typo/FontGlyphSet.h>
+#include "AdvanceKernels.h"
+#include <limits>
 
 
 namespace Tg
@@ -13,17 +15,21 @@ namespace Tg
 
 
 FontGlyphSet::FontGlyphSet(FontGlyphSet&& rhs) :
-    isVertical  { rhs.isVertical         },
-    glyphRange_ { rhs.glyphRange_        },
-    glyphs_     { std::move(rhs.glyphs_) }
+    isVertical    { rhs.isVertical               },
+    border        { rhs.border                   },
+    glyphRange_   { rhs.glyphRange_              },
+    glyphs_       { std::move(rhs.glyphs_)       },
+    advanceTable_ { std::move(rhs.advanceTable_) }
 {
 }
 
 FontGlyphSet& FontGlyphSet::operator = (FontGlyphSet&& rhs)
 {
-    isVertical  = rhs.isVertical;
-    glyphRange_ = rhs.glyphRange_;
-    glyphs_     = std::move(rhs.glyphs_);
+    isVertical    = rhs.isVertical;
+    border        = rhs.border;
+    glyphRange_   = rhs.glyphRange_;
+    glyphs_       = std::move(rhs.glyphs_);
+    advanceTable_ = std::move(rhs.advanceTable_);
     return *this;
 }
 
@@ -31,6 +37,7 @@ void FontGlyphSet::SetGlyphRange(const FontGlyphRange& glyphRange)
 {
     glyphRange_ = glyphRange;
     glyphs_.resize(glyphRange_.GetSize());
+    advanceTable_.clear();
 }
 
 const FontGlyph& FontGlyphSet::operator [] (char chr) const
@@ -44,6 +51,17 @@ const FontGlyph& FontGlyphSet::operator [] (wchar_t chr) const
     return ((chr < glyphRange_.first || chr > glyphRange_.last) ? dummy : glyphs_[chr - glyphRange_.first]);
 }
 
+const FontGlyph& FontGlyphSet::operator [] (char16_t chr) const
+{
+    return (*this)[static_cast<char32_t>(chr)];
+}
+
+const FontGlyph& FontGlyphSet::operator [] (char32_t chr) const
+{
+    static const FontGlyph dummy;
+    return (chr <= static_cast<char32_t>(std::numeric_limits<wchar_t>::max()) ? (*this)[static_cast<wchar_t>(chr)] : dummy);
+}
+
 FontGlyph& FontGlyphSet::operator [] (char chr)
 {
     return (*this)[static_cast<wchar_t>(static_cast<std::uint8_t>(chr))];
@@ -52,9 +70,130 @@ FontGlyph& FontGlyphSet::operator [] (char chr)
 FontGlyph& FontGlyphSet::operator [] (wchar_t chr)
 {
     static FontGlyph dummy;
+    advanceTable_.clear();
     return ((chr < glyphRange_.first || chr > glyphRange_.last) ? dummy : glyphs_[chr - glyphRange_.first]);
 }
 
+FontGlyph& FontGlyphSet::operator [] (char16_t chr)
+{
+    return (*this)[static_cast<char32_t>(chr)];
+}
+
+FontGlyph& FontGlyphSet::operator [] (char32_t chr)
+{
+    static FontGlyph dummy;
+    advanceTable_.clear();
+    return (chr <= static_cast<char32_t>(std::numeric_limits<wchar_t>::max()) ? (*this)[static_cast<wchar_t>(chr)] : dummy);
+}
+
+int FontGlyphSet::TextWidth(const std::string& text) const
+{
+    return TextWidth(text, 0);
+}
+
+int FontGlyphSet::TextWidth(const std::string& text, std::string::size_type position, std::string::size_type count) const
+{
+    if (advanceTable_.empty())
+        return TextWidth<char>(text, position, count);
+
+    if (text.empty() || position >= text.size() || count == 0)
+        return 0;
+
+    if (count == std::string::npos || count + position > text.size())
+        count = text.size() - position;
+
+    /* Sum ASCII runs with the advance table, and decode all other characters */
+    auto str = text.data() + position;
+    auto bytes = reinterpret_cast<const std::uint8_t*>(str);
+
+    int width = 0;
+
+    for (std::size_t i = 0; i < count;)
+    {
+        auto run = ASCIIRunLength(bytes + i, count - i);
+        width += SumAdvances(advanceTable_.data(), bytes + i, run);
+        i += run;
+
+        if (i < count)
+            width += (*this)[DecodeCodePoint(str, count, i)].advance;
+    }
+
+    return width;
+}
+
+std::string::size_type FontGlyphSet::TextFit(
+    const std::string&      text,
+    std::string::size_type  position,
+    std::string::size_type  count,
+    int                     maxWidth,
+    int&                    width) const
+{
+    if (advanceTable_.empty())
+        return TextFit<char>(text, position, count, maxWidth, width);
+
+    width = 0;
+
+    if (position >= text.size())
+        return 0;
+
+    if (count == std::string::npos || count + position > text.size())
+        count = text.size() - position;
+
+    /* Fit ASCII runs with the advance table, and decode all other characters */
+    auto str = text.data() + position;
+    auto bytes = reinterpret_cast<const std::uint8_t*>(str);
+
+    std::size_t i = 0;
+
+    while (i < count)
+    {
+        int runWidth = 0;
+        auto run = ASCIIRunLength(bytes + i, count - i);
+        auto fit = FitAdvances(advanceTable_.data(), bytes + i, run, maxWidth - width, runWidth);
+
+        width += runWidth;
+        i += fit;
+
+        if (fit < run || i == count)
+            break;
+
+        auto next = i;
+        auto advance = (*this)[DecodeCodePoint(str, count, next)].advance;
+        if (width + advance > maxWidth)
+            break;
+
+        width += advance;
+        i = next;
+    }
+
+    return i;
+}
+
+int FontGlyphSet::GetMonospaceAdvance() const
+{
+    int advance = 0;
+
+    for (const auto& glyph : glyphs_)
+    {
+        if (glyph.advance != 0)
+        {
+            if (advance == 0)
+                advance = glyph.advance;
+            else if (advance != glyph.advance)
+                return 0;
+        }
+    }
+
+    return advance;
+}
+
+void FontGlyphSet::UpdateAdvanceTable()
+{
+    advanceTable_.resize(256);
+    for (int i = 0; i < 256; ++i)
+        advanceTable_[i] = static_cast<const FontGlyphSet&>(*this)[static_cast<wchar_t>(i)].advance;
+}
+
 
 } // /namespace Tg
 
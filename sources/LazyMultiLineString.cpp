@@ -0,0 +1,383 @@
+/*
+ * LazyMultiLineString.cpp
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Typo/LazyMultiLineString.h>
+#include <algorithm>
+
+
+namespace Tg
+{
+
+
+template <typename T>
+BasicLazyMultiLineString<T>::BasicLazyMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const StringType& text) :
+    glyphSet_ { &glyphSet },
+    maxWidth_ { maxWidth  }
+{
+    UpdateAverageAdvance();
+    SetText(text);
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::SetText(const StringType& text)
+{
+    /* Reset paragraphs and layouts */
+    text_ = text;
+    paragraphOffsets_.clear();
+    layouts_.clear();
+    lineTree_.assign(1, 0);
+
+    /* Split text into paragraphs */
+    if (!text_.empty())
+    {
+        paragraphOffsets_.push_back(0);
+        AppendParagraphs(0);
+    }
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::Append(const StringType& text)
+{
+    if (text_.empty())
+    {
+        SetText(text);
+        return;
+    }
+
+    if (text.empty())
+        return;
+
+    /* Discard layout of the last paragraph, which will be continued */
+    auto lastParagraph = GetParagraphCount() - 1;
+    auto lastCount = ParagraphLineCount(lastParagraph);
+    layouts_.erase(lastParagraph);
+
+    /* Append text and new paragraphs (the end of the text is the first offset to be replaced) */
+    auto offset = text_.size();
+    text_ += text;
+
+    paragraphOffsets_.pop_back();
+    AppendParagraphs(offset);
+
+    TreeAdd(lastParagraph, EstimateLineCount(lastParagraph) - lastCount);
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::SetGlyphSet(const FontGlyphSet& glyphSet)
+{
+    glyphSet_ = &glyphSet;
+    UpdateAverageAdvance();
+    ResetLayouts();
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::SetMaxWidth(int maxWidth)
+{
+    if (maxWidth_ != maxWidth)
+    {
+        maxWidth_ = maxWidth;
+        ResetLayouts();
+    }
+}
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::GetLineCount() const
+{
+    return TreePrefix(GetParagraphCount());
+}
+
+template <typename T>
+const typename BasicLazyMultiLineString<T>::TextLine& BasicLazyMultiLineString<T>::GetLine(SizeType lineIndex)
+{
+    static const TextLine dummyLine;
+
+    if (text_.empty())
+        return dummyLine;
+
+    SizeType firstLine = 0;
+    auto paragraph = FindLine(lineIndex, firstLine);
+
+    return layouts_[paragraph][lineIndex - firstLine];
+}
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::GetLines(SizeType firstLine, SizeType numLines, std::vector<TextLine>& lines)
+{
+    lines.clear();
+
+    if (text_.empty())
+        return 0;
+
+    /* Find first paragraph */
+    SizeType lineIndex = firstLine;
+    auto paragraph = FindLine(lineIndex, firstLine);
+    auto lineInParagraph = lineIndex - firstLine;
+
+    /* Append lines paragraph by paragraph, until the viewport is filled */
+    for (auto numParagraphs = GetParagraphCount(); paragraph < numParagraphs && lines.size() < numLines; ++paragraph)
+    {
+        const auto& paragraphLines = LayoutParagraph(paragraph);
+
+        auto count = std::min(paragraphLines.size() - lineInParagraph, numLines - lines.size());
+        lines.insert(lines.end(), paragraphLines.begin() + lineInParagraph, paragraphLines.begin() + lineInParagraph + count);
+
+        lineInParagraph = 0;
+    }
+
+    return lineIndex;
+}
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::GetTextIndex(SizeType lineIndex, SizeType positionInLine)
+{
+    if (lineIndex >= GetLineCount())
+        return StringType::npos;
+
+    SizeType firstLine = 0;
+    auto paragraph = FindLine(lineIndex, firstLine);
+    const auto& line = layouts_[paragraph][lineIndex - firstLine];
+
+    if (positionInLine > line.text.size())
+        return StringType::npos;
+
+    return line.offset + positionInLine;
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::GetTextPosition(SizeType textIndex, SizeType& lineIndex, SizeType& positionInLine)
+{
+    /* Reset output parameters and valid text index */
+    lineIndex = 0;
+    positionInLine = 0;
+
+    if (text_.empty())
+        return;
+
+    textIndex = std::min(textIndex, text_.size());
+
+    /* Find paragraph which contains the text index (the new-line character belongs to the paragraph before) */
+    auto paragraph = static_cast<SizeType>(
+        std::distance(
+            paragraphOffsets_.begin(),
+            std::upper_bound(paragraphOffsets_.begin(), paragraphOffsets_.end() - 1, textIndex)
+        )
+    ) - 1;
+
+    /* Find line within the paragraph (see BasicMultiLineString::GetTextPosition) */
+    const auto& lines = LayoutParagraph(paragraph);
+
+    auto it = std::upper_bound(
+        lines.begin(), lines.end(), textIndex,
+        [](SizeType index, const TextLine& line)
+        {
+            return index < line.offset;
+        }
+    );
+
+    lineIndex = TreePrefix(paragraph) + static_cast<SizeType>(std::distance(lines.begin(), it)) - 1;
+    positionInLine = std::min(textIndex - it[-1].offset, it[-1].text.size());
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::EstimateLineCount(SizeType paragraph) const
+{
+    /* Estimate paragraph width by its number of code units */
+    auto length = paragraphOffsets_[paragraph + 1] - 1 - paragraphOffsets_[paragraph];
+    auto width = length * static_cast<SizeType>(averageAdvance_);
+
+    if (maxWidth_ <= 0)
+        return std::max(length, SizeType(1));
+
+    auto maxWidth = static_cast<SizeType>(maxWidth_);
+    return std::max((width + maxWidth - 1) / maxWidth, SizeType(1));
+}
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::ParagraphLineCount(SizeType paragraph) const
+{
+    auto it = layouts_.find(paragraph);
+    return (it != layouts_.end() ? it->second.size() : EstimateLineCount(paragraph));
+}
+
+template <typename T>
+const std::vector<typename BasicLazyMultiLineString<T>::TextLine>& BasicLazyMultiLineString<T>::LayoutParagraph(SizeType paragraph)
+{
+    auto it = layouts_.find(paragraph);
+    if (it != layouts_.end())
+        return it->second;
+
+    /* Wrap paragraph text */
+    auto start = paragraphOffsets_[paragraph];
+    auto end = paragraphOffsets_[paragraph + 1] - 1;
+
+    BasicMultiLineString<T> paragraphText(*glyphSet_, maxWidth_, text_.substr(start, end - start));
+
+    auto lines = paragraphText.GetLines();
+
+    /* Move line offsets into the main text (an empty paragraph still has one line) */
+    for (auto& line : lines)
+        line.offset += start;
+
+    if (lines.empty())
+        lines.push_back({ StringType(), 0, start });
+
+    /* Replace estimated line count */
+    TreeAdd(paragraph, lines.size() - EstimateLineCount(paragraph));
+
+    return (layouts_[paragraph] = std::move(lines));
+}
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::FindLine(SizeType& lineIndex, SizeType& firstLineOfParagraph)
+{
+    while (true)
+    {
+        /* Find paragraph by the current (possibly estimated) line counts */
+        lineIndex = std::min(lineIndex, GetLineCount() - 1);
+        auto paragraph = TreeFind(lineIndex);
+
+        if (layouts_.find(paragraph) != layouts_.end())
+        {
+            firstLineOfParagraph = TreePrefix(paragraph);
+            return paragraph;
+        }
+
+        /* Wrap paragraph, which changes the line counts, and try again */
+        LayoutParagraph(paragraph);
+    }
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::AppendParagraphs(SizeType offset)
+{
+    /* Store begin of each paragraph after a new-line character (new-line characters are always single code units) */
+    auto str = text_.data();
+
+    for (auto pos = offset, len = text_.size(); pos < len; ++pos)
+    {
+        if (str[pos] == T('\n') || str[pos] == T('\r'))
+            paragraphOffsets_.push_back(pos + 1);
+    }
+
+    paragraphOffsets_.push_back(text_.size() + 1);
+
+    /* Append estimated line counts of the new paragraphs */
+    if (lineTree_.size() == 1)
+        ResetLayouts();
+    else
+    {
+        for (auto numParagraphs = GetParagraphCount(); lineTree_.size() - 1 < numParagraphs;)
+            TreeAppend(EstimateLineCount(lineTree_.size() - 1));
+    }
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::ResetLayouts()
+{
+    layouts_.clear();
+
+    /* Build tree in linear time, by adding each node to its parent */
+    auto n = GetParagraphCount();
+    lineTree_.resize(n + 1);
+    lineTree_[0] = 0;
+
+    for (SizeType i = 1; i <= n; ++i)
+        lineTree_[i] = EstimateLineCount(i - 1);
+
+    for (SizeType i = 1; i <= n; ++i)
+    {
+        auto parent = i + (i & (~i + 1));
+        if (parent <= n)
+            lineTree_[parent] += lineTree_[i];
+    }
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::UpdateAverageAdvance()
+{
+    int advance = 0;
+
+    for (char32_t chr = U' '; chr < U'\x7F'; ++chr)
+        advance += GetGlyphSet()[chr].advance;
+
+    averageAdvance_ = std::max(1, advance / (0x7F - 0x20));
+}
+
+/*
+The line counts are stored in unsigned integers. Negative deltas wrap around,
+but all sums in the tree are non-negative, so the modular arithmetic always results in the exact values.
+*/
+
+template <typename T>
+void BasicLazyMultiLineString<T>::TreeAppend(SizeType count)
+{
+    /* Node 'i' stores the sum of the range (i - lowbit(i), i] */
+    auto i = lineTree_.size();
+    auto lowBit = (i & (~i + 1));
+    lineTree_.push_back(count + TreePrefix(i - 1) - TreePrefix(i - lowBit));
+}
+
+template <typename T>
+void BasicLazyMultiLineString<T>::TreeAdd(SizeType paragraph, SizeType delta)
+{
+    for (auto i = paragraph + 1; i < lineTree_.size(); i += (i & (~i + 1)))
+        lineTree_[i] += delta;
+}
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::TreePrefix(SizeType numParagraphs) const
+{
+    SizeType sum = 0;
+
+    for (auto i = numParagraphs; i > 0; i &= (i - 1))
+        sum += lineTree_[i];
+
+    return sum;
+}
+
+template <typename T>
+typename BasicLazyMultiLineString<T>::SizeType BasicLazyMultiLineString<T>::TreeFind(SizeType lineIndex) const
+{
+    /* Find the number of leading paragraphs, whose line counts sum up to at most 'lineIndex' */
+    auto n = lineTree_.size() - 1;
+
+    SizeType step = 1;
+    while (step * 2 <= n)
+        step *= 2;
+
+    SizeType pos = 0;
+
+    for (; step > 0; step /= 2)
+    {
+        if (pos + step <= n && lineTree_[pos + step] <= lineIndex)
+        {
+            pos += step;
+            lineIndex -= lineTree_[pos];
+        }
+    }
+
+    return pos;
+}
+
+
+template class BasicLazyMultiLineString<char>;
+template class BasicLazyMultiLineString<char16_t>;
+template class BasicLazyMultiLineString<char32_t>;
+template class BasicLazyMultiLineString<wchar_t>;
+
+
+} // /namespace Tg
+
+
+
+// ================================================================================
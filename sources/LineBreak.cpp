@@ -0,0 +1,168 @@
+/*
+ * LineBreak.cpp
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "LineBreak.h"
+#include <algorithm>
+
+
+namespace Tg
+{
+
+
+using LB = LineBreakClass;
+
+/* --- Classification tables --- */
+
+static const LB asciiClasses[128] =
+{
+    LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::BA, LB::LF, LB::BK, LB::BK, LB::CR, LB::CM, LB::CM, // 0x00
+    LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, LB::CM, // 0x10
+    LB::SP, LB::EX, LB::QU, LB::AL, LB::PR, LB::PO, LB::AL, LB::QU, LB::OP, LB::CP, LB::AL, LB::PR, LB::IS, LB::HY, LB::IS, LB::SY, // 0x20
+    LB::NU, LB::NU, LB::NU, LB::NU, LB::NU, LB::NU, LB::NU, LB::NU, LB::NU, LB::NU, LB::IS, LB::IS, LB::AL, LB::AL, LB::AL, LB::EX, // 0x30
+    LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, // 0x40
+    LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::OP, LB::PR, LB::CP, LB::AL, LB::AL, // 0x50
+    LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, // 0x60
+    LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::AL, LB::OP, LB::BA, LB::CL, LB::AL, LB::CM, // 0x70
+};
+
+struct LineBreakRange
+{
+    char32_t    first;
+    char32_t    last;
+    LB          lbClass;
+};
+
+// Sorted, non-overlapping ranges of all non-ASCII characters, whose class is not AL
+static const LineBreakRange rangeClasses[] =
+{
+    { 0x0080, 0x0084, LB::CM }, { 0x0085, 0x0085, LB::BK }, { 0x0086, 0x009F, LB::CM }, { 0x00A0, 0x00A0, LB::GL },
+    { 0x00A1, 0x00A1, LB::OP }, { 0x00A2, 0x00A2, LB::PO }, { 0x00A3, 0x00A5, LB::PR }, { 0x00AB, 0x00AB, LB::QU },
+    { 0x00AD, 0x00AD, LB::BA }, { 0x00B0, 0x00B0, LB::PO }, { 0x00B1, 0x00B1, LB::PR }, { 0x00B4, 0x00B4, LB::BB },
+    { 0x00BB, 0x00BB, LB::QU }, { 0x00BF, 0x00BF, LB::OP }, { 0x02C8, 0x02C8, LB::BB }, { 0x02CC, 0x02CC, LB::BB },
+    { 0x0300, 0x036F, LB::CM }, { 0x0483, 0x0489, LB::CM }, { 0x1100, 0x11FF, LB::ID }, { 0x1680, 0x1680, LB::BA },
+    { 0x1AB0, 0x1AFF, LB::CM }, { 0x1DC0, 0x1DFF, LB::CM }, { 0x2000, 0x2006, LB::BA }, { 0x2007, 0x2007, LB::GL },
+    { 0x2008, 0x200A, LB::BA }, { 0x200B, 0x200B, LB::ZW }, { 0x200C, 0x200D, LB::CM }, { 0x2010, 0x2010, LB::BA },
+    { 0x2011, 0x2011, LB::GL }, { 0x2012, 0x2013, LB::BA }, { 0x2014, 0x2014, LB::B2 }, { 0x2018, 0x2019, LB::QU },
+    { 0x201A, 0x201A, LB::OP }, { 0x201B, 0x201D, LB::QU }, { 0x201E, 0x201E, LB::OP }, { 0x201F, 0x201F, LB::QU },
+    { 0x2024, 0x2026, LB::IN }, { 0x2027, 0x2027, LB::BA }, { 0x2028, 0x2029, LB::BK }, { 0x202F, 0x202F, LB::GL },
+    { 0x2030, 0x2037, LB::PO }, { 0x2039, 0x203A, LB::QU }, { 0x203C, 0x203D, LB::NS }, { 0x2044, 0x2044, LB::IS },
+    { 0x2045, 0x2045, LB::OP }, { 0x2046, 0x2046, LB::CL }, { 0x2047, 0x2049, LB::NS }, { 0x2060, 0x2060, LB::WJ },
+    { 0x20A0, 0x20CF, LB::PR }, { 0x20D0, 0x20FF, LB::CM }, { 0x2E80, 0x2FFF, LB::ID }, { 0x3000, 0x3000, LB::BA },
+    { 0x3001, 0x3002, LB::CL }, { 0x3003, 0x3004, LB::ID }, { 0x3005, 0x3005, LB::NS }, { 0x3006, 0x3007, LB::ID },
+    { 0x3008, 0x3008, LB::OP }, { 0x3009, 0x3009, LB::CL }, { 0x300A, 0x300A, LB::OP }, { 0x300B, 0x300B, LB::CL },
+    { 0x300C, 0x300C, LB::OP }, { 0x300D, 0x300D, LB::CL }, { 0x300E, 0x300E, LB::OP }, { 0x300F, 0x300F, LB::CL },
+    { 0x3010, 0x3010, LB::OP }, { 0x3011, 0x3011, LB::CL }, { 0x3012, 0x3013, LB::ID }, { 0x3014, 0x3014, LB::OP },
+    { 0x3015, 0x3015, LB::CL }, { 0x3016, 0x3016, LB::OP }, { 0x3017, 0x3017, LB::CL }, { 0x3018, 0x3018, LB::OP },
+    { 0x3019, 0x3019, LB::CL }, { 0x301A, 0x301A, LB::OP }, { 0x301B, 0x301B, LB::CL }, { 0x301C, 0x301C, LB::NS },
+    { 0x301D, 0x301D, LB::OP }, { 0x301E, 0x301F, LB::CL }, { 0x3020, 0x3029, LB::ID }, { 0x302A, 0x302F, LB::CM },
+    { 0x3030, 0x303A, LB::ID }, { 0x303B, 0x303C, LB::NS }, { 0x303D, 0x303F, LB::ID }, { 0x3041, 0x3041, LB::NS },
+    { 0x3042, 0x3042, LB::ID }, { 0x3043, 0x3043, LB::NS }, { 0x3044, 0x3044, LB::ID }, { 0x3045, 0x3045, LB::NS },
+    { 0x3046, 0x3046, LB::ID }, { 0x3047, 0x3047, LB::NS }, { 0x3048, 0x3048, LB::ID }, { 0x3049, 0x3049, LB::NS },
+    { 0x304A, 0x3062, LB::ID }, { 0x3063, 0x3063, LB::NS }, { 0x3064, 0x3082, LB::ID }, { 0x3083, 0x3083, LB::NS },
+    { 0x3084, 0x3084, LB::ID }, { 0x3085, 0x3085, LB::NS }, { 0x3086, 0x3086, LB::ID }, { 0x3087, 0x3087, LB::NS },
+    { 0x3088, 0x308D, LB::ID }, { 0x308E, 0x308E, LB::NS }, { 0x308F, 0x3094, LB::ID }, { 0x3095, 0x3096, LB::NS },
+    { 0x3099, 0x309A, LB::CM }, { 0x309B, 0x309E, LB::NS }, { 0x309F, 0x309F, LB::ID }, { 0x30A0, 0x30A0, LB::NS },
+    { 0x30A1, 0x30FA, LB::ID }, { 0x30FB, 0x30FE, LB::NS }, { 0x30FF, 0x31EF, LB::ID }, { 0x31F0, 0x31FF, LB::NS },
+    { 0x3200, 0x4DBF, LB::ID }, { 0x4E00, 0x9FFF, LB::ID }, { 0xA000, 0xA4CF, LB::ID }, { 0xAC00, 0xD7A3, LB::ID },
+    { 0xF900, 0xFAFF, LB::ID }, { 0xFE00, 0xFE0F, LB::CM }, { 0xFE20, 0xFE2F, LB::CM }, { 0xFEFF, 0xFEFF, LB::WJ },
+    { 0xFF01, 0xFF01, LB::EX }, { 0xFF02, 0xFF03, LB::ID }, { 0xFF04, 0xFF04, LB::PR }, { 0xFF05, 0xFF05, LB::PO },
+    { 0xFF06, 0xFF07, LB::ID }, { 0xFF08, 0xFF08, LB::OP }, { 0xFF09, 0xFF09, LB::CL }, { 0xFF0A, 0xFF0B, LB::ID },
+    { 0xFF0C, 0xFF0C, LB::CL }, { 0xFF0D, 0xFF0D, LB::ID }, { 0xFF0E, 0xFF0E, LB::CL }, { 0xFF0F, 0xFF19, LB::ID },
+    { 0xFF1A, 0xFF1B, LB::NS }, { 0xFF1C, 0xFF1E, LB::ID }, { 0xFF1F, 0xFF1F, LB::EX }, { 0xFF20, 0xFF3A, LB::ID },
+    { 0xFF3B, 0xFF3B, LB::OP }, { 0xFF3C, 0xFF3C, LB::ID }, { 0xFF3D, 0xFF3D, LB::CL }, { 0xFF3E, 0xFF5A, LB::ID },
+    { 0xFF5B, 0xFF5B, LB::OP }, { 0xFF5C, 0xFF5C, LB::ID }, { 0xFF5D, 0xFF5D, LB::CL }, { 0xFF5E, 0xFF5E, LB::ID },
+    { 0xFF5F, 0xFF5F, LB::OP }, { 0xFF60, 0xFF61, LB::CL }, { 0xFF62, 0xFF62, LB::OP }, { 0xFF63, 0xFF64, LB::CL },
+    { 0xFF65, 0xFF65, LB::NS }, { 0xFFE0, 0xFFE0, LB::PO }, { 0xFFE1, 0xFFE1, LB::PR }, { 0xFFE5, 0xFFE6, LB::PR },
+    { 0x1F000, 0x1FAFF, LB::ID }, { 0x20000, 0x2FFFD, LB::ID }, { 0x30000, 0x3FFFD, LB::ID }, { 0xE0100, 0xE01EF, LB::CM },
+};
+
+/*
+Pair table of the Unicode line breaking algorithm (UAX #14), indexed by [before][after]:
+'_' direct break, '%' indirect break (only after spaces), '#' combining indirect break,
+'@' combining prohibited break, and '^' prohibited break.
+*/
+static const char pairTable[22][23] =
+{
+//   OP CL CP QU GL NS EX SY IS PR PO NU AL ID IN HY BA BB B2 ZW CM WJ
+    "^^^^^^^^^^^^^^^^^^^^@^", // OP
+    "_^^%%^^^^%%____%%__^#^", // CL
+    "_^^%%^^^^%%%%__%%__^#^", // CP
+    "^^^%%%^^^%%%%%%%%%%^#^", // QU
+    "%^^%%%^^^%%%%%%%%%%^#^", // GL
+    "_^^%%%^^^______%%__^#^", // NS
+    "_^^%%%^^^______%%__^#^", // EX
+    "_^^%%%^^^__%___%%__^#^", // SY
+    "_^^%%%^^^__%%__%%__^#^", // IS
+    "%^^%%%^^^__%%%_%%__^#^", // PR
+    "%^^%%%^^^__%%__%%__^#^", // PO
+    "%^^%%%^^^%%%%_%%%__^#^", // NU
+    "%^^%%%^^^__%%_%%%__^#^", // AL
+    "_^^%%%^^^_%___%%%__^#^", // ID
+    "_^^%%%^^^_____%%%__^#^", // IN
+    "_^^%_%^^^__%___%%__^#^", // HY
+    "_^^%_%^^^______%%__^#^", // BA
+    "%^^%%%^^^%%%%%%%%%%^#^", // BB
+    "_^^%%%^^^______%%_^^#^", // B2
+    "___________________^__", // ZW
+    "%^^%%%^^^__%%_%%%__^#^", // CM
+    "%^^%%%^^^%%%%%%%%%%^#^", // WJ
+};
+
+
+/* --- Global functions --- */
+
+LineBreakClass GetLineBreakClass(char32_t chr)
+{
+    if (chr < 0x80)
+        return asciiClasses[chr];
+
+    /* Find the last range which begins at or before the character */
+    auto it = std::upper_bound(
+        std::begin(rangeClasses), std::end(rangeClasses), chr,
+        [](char32_t c, const LineBreakRange& range)
+        {
+            return c < range.first;
+        }
+    );
+
+    if (it != std::begin(rangeClasses))
+    {
+        --it;
+        if (chr <= it->last)
+            return it->lbClass;
+    }
+
+    return LB::AL;
+}
+
+bool IsLineBreakAllowed(LineBreakClass before, LineBreakClass after, bool spaceBefore, bool& attach)
+{
+    attach = false;
+
+    switch (pairTable[static_cast<int>(before)][static_cast<int>(after)])
+    {
+        case '_':
+            return true;
+        case '%':
+            return spaceBefore;
+        case '#':
+            attach = !spaceBefore;
+            return spaceBefore;
+        case '@':
+            attach = !spaceBefore;
+            return false;
+        default:
+            return false;
+    }
+}
+
+
+} // /namespace Tg
+
+
+
+// ================================================================================
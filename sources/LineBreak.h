@@ -0,0 +1,117 @@
+/*
+ * LineBreak.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_LINE_BREAK_H
+#define TG_LINE_BREAK_H
+
+
+#include <Typo/Unicode.h>
+#include <string>
+#include <cstdint>
+
+
+namespace Tg
+{
+
+
+/**
+\brief Line breaking classes of the Unicode line breaking algorithm (UAX #14).
+\remarks Only the classes which have an entry in the pair table are listed here.
+Other classes are resolved to one of these (e.g. AI, SA, and XX to AL, CJ to NS, and H2, H3, JL, JV, JT to ID).
+*/
+enum class LineBreakClass : std::uint8_t
+{
+    OP, CL, CP, QU, GL, NS, EX, SY, IS, PR, PO, NU, AL, ID, IN, HY, BA, BB, B2, ZW, CM, WJ,
+    BK, CR, LF, SP,
+};
+
+//! Returns the line breaking class of the specified character.
+LineBreakClass GetLineBreakClass(char32_t chr);
+
+/**
+\brief Returns true if a line break is allowed between two characters of the specified classes.
+\param[in] before Specifies the class of the last non-space character before the break.
+\param[in] after Specifies the class of the character after the break.
+\param[in] spaceBefore Specifies whether one or more spaces appear immediately before the break.
+\param[out] attach Specifies whether the character after the break attaches to the previous character, i.e. combining marks.
+\remarks Both classes must be pair table classes (i.e. neither BK, CR, LF, nor SP).
+*/
+bool IsLineBreakAllowed(LineBreakClass before, LineBreakClass after, bool spaceBefore, bool& attach);
+
+/**
+\brief Computes the line break opportunities of the specified text range.
+\param[in] text Specifies the text. This range should not contain any new-line characters.
+\param[in] start Specifies the start of the text range (i.e. the paragraph).
+\param[in] end Specifies the end of the text range.
+\param[in] onBreak Specifies the callback 'void(std::size_t pos)', which is called in ascending order for each position where a line may begin.
+The start and end of the text range are never reported.
+*/
+template <typename T, typename BreakCallback>
+void ComputeLineBreaks(const std::basic_string<T>& text, std::size_t start, std::size_t end, const BreakCallback& onBreak)
+{
+    if (start >= end)
+        return;
+
+    /* Resolve class of the first character (spaces at the beginning behave like word joiners) */
+    auto pos = start;
+    auto before = GetLineBreakClass(DecodeCodePoint(text.data(), end, pos));
+
+    if (before == LineBreakClass::SP)
+        before = LineBreakClass::WJ;
+    else if (before == LineBreakClass::BK || before == LineBreakClass::CR || before == LineBreakClass::LF)
+        before = LineBreakClass::BK;
+
+    bool spaceBefore = false;
+
+    while (pos < end)
+    {
+        auto chrPos = pos;
+        auto after = GetLineBreakClass(DecodeCodePoint(text.data(), end, pos));
+
+        /* Always break after mandatory breaks */
+        if (before == LineBreakClass::BK)
+        {
+            onBreak(chrPos);
+            before = after;
+            spaceBefore = false;
+            continue;
+        }
+
+        /* Never break before spaces and mandatory breaks */
+        if (after == LineBreakClass::SP)
+        {
+            spaceBefore = true;
+            continue;
+        }
+        if (after == LineBreakClass::BK || after == LineBreakClass::CR || after == LineBreakClass::LF)
+        {
+            before = LineBreakClass::BK;
+            spaceBefore = false;
+            continue;
+        }
+
+        /* Look up pair table */
+        bool attach = false;
+        if (IsLineBreakAllowed(before, after, spaceBefore, attach))
+            onBreak(chrPos);
+
+        if (!attach)
+            before = after;
+
+        spaceBefore = false;
+    }
+}
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
@@ -6,120 +6,83 @@
  */
 
 #include <Typo/MultiLineString.h>
+#include "LineBreak.h"
+#include "ParallelFor.h"
 #include <algorithm>
+#include <iterator>
 
 
 namespace Tg
 {
 
 
-MultiLineString::MultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const String& text) :
+template <typename T>
+BasicMultiLineString<T>::BasicMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const StringType& text) :
     glyphSet_ { &glyphSet },
     maxWidth_ { maxWidth  },
     width_    { 0         },
     text_     { text      }
 {
+    RebuildBreaks();
+    RebuildAdvances();
     RebuildLines();
 }
 
-MultiLineString& MultiLineString::operator = (const String& str)
+template <typename T>
+BasicMultiLineString<T>& BasicMultiLineString<T>::operator = (const StringType& str)
 {
     SetText(str);
     return *this;
 }
 
-MultiLineString& MultiLineString::operator += (const String& str)
+template <typename T>
+BasicMultiLineString<T>& BasicMultiLineString<T>::operator += (const StringType& str)
 {
-    for (const auto& chr : str)
-        PushBack(chr);
+    UpdateAttributeSpans(text_.size(), 0, str.size());
+    text_ += str;
+    RebuildBreaks();
+    RebuildAdvances();
+    RebuildLines();
     return *this;
 }
 
-MultiLineString& MultiLineString::operator += (const Char& chr)
+template <typename T>
+BasicMultiLineString<T>& BasicMultiLineString<T>::operator += (const T& chr)
 {
     PushBack(chr);
     return *this;
 }
 
-void MultiLineString::PushBack(const Char& chr)
+template <typename T>
+void BasicMultiLineString<T>::PushBack(const T& chr)
 {
     /* Update main string */
+    UpdateAttributeSpans(text_.size(), 0, 1);
     text_ += chr;
 
-#if 1
+    RebuildBreaks();
+    RebuildAdvances();
     RebuildLines();
-#else
-    if (IsNewLine(chr))
-        AppendLine();
-    else
-    {
-        /* Get width of new character */
-        auto width = CharWidth(chr);
-
-        if (lines_.empty())
-        {
-            /* Add first character without width-check */
-            AppendLine(chr, width);
-        }
-        else
-        {
-            /* Try to append character to last line */
-            auto& line = lines_.back();
-
-            /* Check if character fits into last line */
-            if (FitIntoLine(line.width + width))
-            {
-                /* Update line and widest width */
-                line.width += width;
-                line.text += chr;
-                UpdateWidestWidth(line.width);
-            }
-            else
-                RebuildLines();
-        }
-    }
-#endif
 }
 
-void MultiLineString::PopBack()
+template <typename T>
+void BasicMultiLineString<T>::PopBack()
 {
     if (lines_.empty() || text_.empty())
         return;
 
     /* Update main string */
-    text_.pop_back();
+    auto textPos = PrevCodePoint(text_, text_.size());
+    UpdateAttributeSpans(textPos, text_.size() - textPos, 0);
+    text_.erase(textPos);
 
-#if 1
+    RebuildBreaks();
+    RebuildAdvances();
     RebuildLines();
-#else
-    /* Get last character from last line */
-    auto& line = lines_.back();
-    auto chr = line.text.back();
-
-    auto lineWidth = line.width;
-
-    /* Remove last character from last line */
-    line.text.pop_back();
-
-    if (line.text.empty())
-    {
-        /* Remove last line if it's empty */
-        lines_.pop_back();
-    }
-    else
-    {
-        /* Update width in current line */
-        int width = CharWidth(chr);
-        line.width -= width;
-    }
-
-    /* Update widest width when a character is removed from the current widest line */
-    if (lineWidth == width_)
-        UpdateWidestWidth();
-#endif
 }
 
-void MultiLineString::Insert(SizeType lineIndex, SizeType positionInLine, const Char& chr, bool replace)
+template <typename T>
+void BasicMultiLineString<T>::Insert(SizeType lineIndex, SizeType positionInLine, const T& chr, bool replace)
 {
     /* Check if push-back is sufficient */
     if (lines_.empty() && lineIndex == 0 && positionInLine == 0)
@@ -144,7 +107,7 @@ void MultiLineString::Insert(SizeType lineIndex, SizeType positionInLine, const
         return;
     }
 
-    if (positionInLine == line.text.size() || IsNewLine(chr))
+    if (positionInLine == line.text.size() || IsNewLine(chr) || IsContinuationUnit(chr))
         replace = false;
 
     /* Update main string */
@@ -152,57 +115,70 @@ void MultiLineString::Insert(SizeType lineIndex, SizeType positionInLine, const
     if (replace)
     {
         if (textPos < text_.size())
-            text_[textPos] = chr;
+        {
+            auto length = NextCodePoint(text_, textPos) - textPos;
+            UpdateAttributeSpans(textPos, length, 1);
+            text_.replace(textPos, length, 1, chr);
+        }
         else
             return;
     }
     else
+    {
+        UpdateAttributeSpans(textPos, 0, 1);
         text_.insert(textPos, 1, chr);
+    }
 
-    /* Update selected line with new character */
-#if 1
+    /* Update lines */
+    RebuildBreaks();
+    RebuildAdvances();
     RebuildLines();
-#else
-    if (IsNewLine(chr))
-        RebuildLines();
-    else
+}
+
+template <typename T>
+void BasicMultiLineString<T>::Insert(SizeType lineIndex, SizeType positionInLine, const StringType& str, bool replace)
+{
+    if (str.empty())
+        return;
+
+    /* Get text position */
+    SizeType textPos = 0;
+
+    if (!lines_.empty() || lineIndex != 0 || positionInLine != 0)
     {
-        /* Get width of new character */
-        auto width = CharWidth(chr);
+        textPos = GetTextIndex(lineIndex, positionInLine);
+        if (textPos == StringType::npos)
+            return;
+    }
 
-        if (replace)
-        {
-            auto prevWidth = CharWidth(line.text[positionInLine]);
+    /* Find end of the characters to be replaced */
+    auto replaceEnd = textPos;
 
-            /* Check if character fits into current line */
-            if (FitIntoLine(line.width + width - prevWidth))
-            {
-                /* Replace character and update widest width */
-                line.width += width - prevWidth;
-                line.text[positionInLine] = chr;
-                UpdateWidestWidth(line.width);
-            }
-            else
-                RebuildLines();
-        }
-        else
+    if (replace)
+    {
+        for (SizeType pos = 0, len = str.size(); pos < len && replaceEnd < text_.size(); )
         {
-            /* Check if character fits into current line */
-            if (FitIntoLine(line.width + width))
-            {
-                /* Insert character and update widest width */
-                line.width += width;
-                line.text.insert(positionInLine, 1, chr);
-                UpdateWidestWidth(line.width);
-            }
-            else
-                RebuildLines();
+            auto chr = DecodeCodePoint(str, pos);
+            if (IsNewLine(chr))
+                continue;
+            if (IsNewLine(static_cast<char32_t>(text_[replaceEnd])))
+                break;
+            replaceEnd = NextCodePoint(text_, replaceEnd);
         }
     }
-#endif
+
+    /* Update main string */
+    UpdateAttributeSpans(textPos, replaceEnd - textPos, str.size());
+    text_.replace(textPos, replaceEnd - textPos, str);
+
+    /* Update lines */
+    RebuildBreaks();
+    RebuildAdvances();
+    RebuildLines();
 }
 
-void MultiLineString::Remove(SizeType lineIndex, SizeType positionInLine)
+template <typename T>
+void BasicMultiLineString<T>::Remove(SizeType lineIndex, SizeType positionInLine)
 {
     /* Validate parameters and get selected line */
     if (lineIndex >= lines_.size())
@@ -222,63 +198,124 @@ void MultiLineString::Remove(SizeType lineIndex, SizeType positionInLine)
 
     /* Update main string */
     auto textPos = GetTextIndex(lineIndex, positionInLine);
-    auto chr = text_[textPos];
-    text_.erase(textPos, 1);
+    auto length = NextCodePoint(text_, textPos) - textPos;
+    UpdateAttributeSpans(textPos, length, 0);
+    text_.erase(textPos, length);
 
-#if 1
+    RebuildBreaks();
+    RebuildAdvances();
     RebuildLines();
-#else
-    /* Update selected line with removed character */
-    if (IsNewLine(chr))
-        RebuildLines();
-    else
-    {
-        auto lineWidth = line.width;
+}
 
-        /* Remove character from line */
-        line.text.erase(positionInLine, 1);
+template <typename T>
+void BasicMultiLineString<T>::Remove(SizeType lineIndex, SizeType positionInLine, SizeType length)
+{
+    /* Validate parameters */
+    auto textPos = GetTextIndex(lineIndex, positionInLine);
+    if (textPos == StringType::npos || textPos >= text_.size() || length == 0)
+        return;
 
-        if (line.text.empty())
+    /* Update main string (the end is moved to the next code point boundary) */
+    auto textEnd = textPos + std::min(length, text_.size() - textPos);
+    while (textEnd < text_.size() && IsContinuationUnit(text_[textEnd]))
+        ++textEnd;
+
+    UpdateAttributeSpans(textPos, textEnd - textPos, 0);
+    text_.erase(textPos, textEnd - textPos);
+
+    RebuildBreaks();
+    RebuildAdvances();
+    RebuildLines();
+}
+
+template <typename T>
+typename BasicMultiLineString<T>::SizeType BasicMultiLineString<T>::TrimFront(SizeType maxLines, SizeType maxLength)
+{
+    /* Find the first paragraph to keep (the new-line character before a line marks the begin of a paragraph) */
+    SizeType cut = 0, cutLine = 0;
+
+    for (SizeType i = 1, n = lines_.size(); i < n; ++i)
+    {
+        if (n - cutLine <= maxLines && text_.size() - cut <= maxLength)
+            break;
+
+        auto offset = lines_[i].offset;
+        if (offset < text_.size() && IsNewLine(static_cast<char32_t>(text_[offset - 1])))
         {
-            /* Remove last line if it's empty */
-            lines_.pop_back();
+            cut = offset;
+            cutLine = i;
         }
-        else
+    }
+
+    if (cut == 0)
+        return 0;
+
+    /* Erase paragraphs from the main string */
+    UpdateAttributeSpans(0, cut, 0);
+    text_.erase(0, cut);
+
+    /* Move remaining lines to the front */
+    lines_.erase(lines_.begin(), lines_.begin() + cutLine);
+
+    for (auto& line : lines_)
+        line.offset -= cut;
+
+    ++layoutVersion_;
+    UpdateWidestWidth();
+
+    /* Move remaining cumulative widths to the front */
+    auto originWidth = advances_[cut];
+    advances_.erase(advances_.begin(), advances_.begin() + cut);
+
+    for (auto& advance : advances_)
+        advance -= originWidth;
+
+    /* Move remaining break points to the front */
+    auto firstBreak = std::lower_bound(
+        breakPoints_.begin(), breakPoints_.end(), cut,
+        [](const BreakPoint& breakPoint, SizeType pos)
         {
-            /* Update width in current line */
-            int width = CharWidth(chr);
-            line.width -= width;
+            return breakPoint.position < pos;
         }
+    );
+
+    auto numBreaks = static_cast<SizeType>(std::distance(breakPoints_.begin(), firstBreak));
+    breakPoints_.erase(breakPoints_.begin(), firstBreak);
 
-        /* Update widest width when a character is removed from the current widest line */
-        if (lineWidth == width_)
-            UpdateWidestWidth();
+    for (auto& breakPoint : breakPoints_)
+    {
+        breakPoint.position -= cut;
+        breakPoint.width    -= originWidth;
     }
-#endif
-}
 
-MultiLineString::SizeType MultiLineString::GetTextIndex(SizeType lineIndex, SizeType positionInLine) const
-{
-    if (lineIndex >= lines_.size() || positionInLine > lines_[lineIndex].text.size())
-        return String::npos;
+    /* Remove erased chunks and let the chunk, which contains the cut, begin at the front */
+    auto chunk = static_cast<SizeType>(std::distance(chunks_.begin(), std::upper_bound(chunks_.begin(), chunks_.end(), cut))) - 1;
 
-    SizeType pos = 0;
+    chunks_.erase(chunks_.begin(), chunks_.begin() + chunk);
+    chunkBreaks_.erase(chunkBreaks_.begin(), chunkBreaks_.begin() + chunk);
 
-    /* Accumulate size of each line until the specified line index */
-    for (SizeType i = 0; i < lineIndex; ++i)
+    for (std::size_t i = 1; i < chunks_.size(); ++i)
     {
-        auto len = lines_[i].text.size();
-        pos += len;
-        if (IsNewLine(text_[pos]))
-            ++pos;
+        chunks_[i]      -= cut;
+        chunkBreaks_[i] -= numBreaks;
     }
 
-    pos += positionInLine;
+    chunks_[0]      = 0;
+    chunkBreaks_[0] = 0;
 
-    return pos;
+    return cut;
+}
+
+template <typename T>
+typename BasicMultiLineString<T>::SizeType BasicMultiLineString<T>::GetTextIndex(SizeType lineIndex, SizeType positionInLine) const
+{
+    if (lineIndex >= lines_.size() || positionInLine > lines_[lineIndex].text.size())
+        return StringType::npos;
+    return lines_[lineIndex].offset + positionInLine;
 }
 
-void MultiLineString::GetTextPosition(SizeType textIndex, SizeType& lineIndex, SizeType& positionInLine) const
+template <typename T>
+void BasicMultiLineString<T>::GetTextPosition(SizeType textIndex, SizeType& lineIndex, SizeType& positionInLine) const
 {
     /* Reset output parameters and valid text index */
     lineIndex = 0;
@@ -288,43 +325,128 @@ void MultiLineString::GetTextPosition(SizeType textIndex, SizeType& lineIndex, S
         return;
 
     textIndex = std::min(textIndex, text_.size());
-    SizeType i = 0;
 
-    while (i < textIndex && lineIndex < lines_.size())
-    {
-        /* Move iteration index */
-        positionInLine = std::min(textIndex - i, lines_[lineIndex].text.size());
-        i += positionInLine;
+    /*
+    Find the last line which begins at or before the text index.
+    If the position is at the end of a line, and this end has no explicit new line character,
+    then this is already the beginning of the next line
+    */
+    auto it = std::upper_bound(
+        lines_.begin(), lines_.end(), textIndex,
+        [](SizeType index, const TextLine& line)
+        {
+            return index < line.offset;
+        }
+    );
+
+    lineIndex = static_cast<SizeType>(std::distance(lines_.begin(), it)) - 1;
+    positionInLine = std::min(textIndex - it[-1].offset, it[-1].text.size());
+}
+
+template <typename T>
+int BasicMultiLineString<T>::LineWidth(SizeType lineIndex, SizeType positionInLine) const
+{
+    if (lineIndex >= lines_.size())
+        return 0;
+
+    const auto& line = lines_[lineIndex];
+    positionInLine = std::min(positionInLine, line.text.size());
+
+    return advances_[line.offset + positionInLine] - advances_[line.offset];
+}
+
+template <typename T>
+typename BasicMultiLineString<T>::SizeType BasicMultiLineString<T>::LineFit(SizeType lineIndex, int maxWidth, int& width) const
+{
+    width = 0;
+
+    if (lineIndex >= lines_.size())
+        return 0;
+
+    const auto& line = lines_[lineIndex];
+
+    /* Find the last position, whose cumulative width does not exceed the maximal width */
+    auto first = advances_.begin() + line.offset;
+    auto last = first + line.text.size() + 1;
+    auto origin = *first;
 
-        if (i < textIndex)
+    auto it = std::upper_bound(
+        first, last, maxWidth,
+        [origin](int maxWidth, int advance)
         {
-            ++lineIndex;
-            if (i < text_.size() && IsNewLine(text_[i]))
-            {
-                ++i;
-                positionInLine = 0;
-            }
+            return maxWidth < advance - origin;
         }
-    }
+    );
 
-    /*
-    If the position is at the end of a line, and this end has no explicit new line character,
-    then move on to the beginning of the next line
-    */
-    if (lineIndex + 1 < lines_.size() && positionInLine == lines_[lineIndex].text.size() && !IsNewLine(text_[i]))
+    if (it == first)
+        return 0;
+
+    auto pos = static_cast<SizeType>(std::distance(first, it)) - 1;
+
+    /* Move to the beginning of the character (continuation units have the width before their character) */
+    while (pos > 0 && pos < line.text.size() && IsContinuationUnit(line.text[pos]))
+        --pos;
+
+    width = advances_[line.offset + pos] - origin;
+
+    return pos;
+}
+
+template <typename T>
+typename BasicMultiLineString<T>::SizeType BasicMultiLineString<T>::LineHitTest(SizeType lineIndex, int x) const
+{
+    if (lineIndex >= lines_.size() || x <= 0)
+        return 0;
+
+    /* Find the first character where the accumulated text width reaches the X coordinate */
+    const auto& text = lines_[lineIndex].text;
+
+    int width = 0;
+    auto pos = LineFit(lineIndex, x - 1, width);
+
+    /* Move to the end of this character, if the coordinate is closer to its right side */
+    if (pos < text.size())
     {
-        ++lineIndex;
-        positionInLine = 0;
+        auto next = NextCodePoint(text, pos);
+        if (x - width > LineWidth(lineIndex, next) - x)
+            pos = next;
     }
+
+    return pos;
 }
 
-void MultiLineString::SetGlyphSet(const FontGlyphSet& glyphSet)
+template <typename T>
+typename BasicMultiLineString<T>::SizeType BasicMultiLineString<T>::HitTest(int x, int y, int lineHeight) const
+{
+    if (lines_.empty())
+        return 0;
+
+    /* Determine line by the line height */
+    SizeType lineIndex = 0;
+    if (y > 0 && lineHeight > 0)
+        lineIndex = std::min(static_cast<SizeType>(y / lineHeight), lines_.size() - 1);
+
+    /* Determine position within the line */
+    const auto& line = lines_[lineIndex];
+    auto pos = LineHitTest(lineIndex, x);
+
+    /* Keep the index before the last character of a wrapped line */
+    if (pos > 0 && pos == line.text.size() && lineIndex + 1 < lines_.size() && line.offset + pos == lines_[lineIndex + 1].offset)
+        pos = PrevCodePoint(line.text, pos);
+
+    return line.offset + pos;
+}
+
+template <typename T>
+void BasicMultiLineString<T>::SetGlyphSet(const FontGlyphSet& glyphSet)
 {
     glyphSet_ = &glyphSet;
+    RebuildAdvances();
     RebuildLines();
 }
 
-void MultiLineString::SetMaxWidth(int maxWidth)
+template <typename T>
+void BasicMultiLineString<T>::SetMaxWidth(int maxWidth)
 {
     if (maxWidth_ != maxWidth)
     {
@@ -333,25 +455,57 @@ void MultiLineString::SetMaxWidth(int maxWidth)
     }
 }
 
-void MultiLineString::SetText(const String& text)
+template <typename T>
+void BasicMultiLineString<T>::SetText(const StringType& text)
 {
+    UpdateAttributeSpans(0, text_.size(), text.size());
     text_ = text;
+    RebuildBreaks();
+    RebuildAdvances();
     RebuildLines();
 }
 
-int MultiLineString::CharWidth(const Char& chr) const
+template <typename T>
+typename BasicMultiLineString<T>::SizeType BasicMultiLineString<T>::FindAttributeSpan(SizeType textIndex) const
+{
+    if (attributeSpans_.empty())
+        return 0;
+
+    auto it = std::upper_bound(
+        attributeSpans_.begin(), attributeSpans_.end(), textIndex,
+        [](SizeType index, const TextAttributeSpan& span)
+        {
+            return index < span.offset;
+        }
+    );
+
+    return static_cast<SizeType>(std::distance(attributeSpans_.begin(), it)) - 1;
+}
+
+template <typename T>
+TextAttribute BasicMultiLineString<T>::GetAttributeAt(SizeType textIndex) const
+{
+    if (attributeSpans_.empty())
+        return TextAttribute();
+    return attributeSpans_[FindAttributeSpan(textIndex)].attribute;
+}
+
+template <typename T>
+int BasicMultiLineString<T>::CharWidth(char32_t chr) const
 {
     return GetGlyphSet()[chr].advance;
 }
 
-bool MultiLineString::IsNewLine(const Char& chr) const
+template <typename T>
+bool BasicMultiLineString<T>::IsNewLine(char32_t chr) const
 {
-    return (chr == Char('\n') || chr == Char('\r'));
+    return (chr == U'\n' || chr == U'\r');
 }
 
-bool MultiLineString::IsSpace(const Char& chr) const
+template <typename T>
+bool BasicMultiLineString<T>::IsSpace(char32_t chr) const
 {
-    return (chr == Char(' ') || chr == Char('\t'));
+    return (chr == U' ' || chr == U'\t');
 }
 
 
@@ -360,115 +514,348 @@ bool MultiLineString::IsSpace(const Char& chr) const
  */
 
 
-bool MultiLineString::FitIntoLine(int width) const
+template <typename T>
+bool BasicMultiLineString<T>::FitIntoLine(int width) const
 {
     return (width <= GetMaxWidth());
 }
 
-void MultiLineString::UpdateWidestWidth(int width)
+template <typename T>
+void BasicMultiLineString<T>::UpdateWidestWidth(int width)
 {
     width_ = std::max(width_, width);
 }
 
-void MultiLineString::UpdateWidestWidth()
+template <typename T>
+void BasicMultiLineString<T>::UpdateWidestWidth()
 {
     width_ = 0;
     for (const auto& line : lines_)
         width_ = std::max(width_, line.width);
 }
 
-void MultiLineString::AppendLine(const String& text, int width)
+/*
+Texts with at least this number of code units are split into chunks of whole paragraphs,
+which are rebuilt in parallel. Smaller texts are always rebuilt on the calling thread.
+*/
+static const std::size_t parallelTextThreshold  = (1u << 20);
+static const std::size_t parallelChunkSize      = (1u << 18);
+
+template <typename T>
+void BasicMultiLineString<T>::RebuildBreaks()
 {
-    lines_.push_back({ text, width });
-    UpdateWidestWidth(width);
-}
+    /* Split text into chunks at paragraph boundaries (new-line characters are always single code units) */
+    auto len = text_.size();
 
-void MultiLineString::AppendLine(const Char& chr, int width)
-{
-    AppendLine(String(1, chr), 0);
+    chunks_.clear();
+    chunks_.push_back(0);
+
+    if (len >= parallelTextThreshold)
+    {
+        for (auto pos = parallelChunkSize; pos < len; pos = chunks_.back() + parallelChunkSize)
+        {
+            while (pos < len && !IsNewLine(static_cast<char32_t>(text_[pos])))
+                ++pos;
+            if (pos >= len)
+                break;
+            chunks_.push_back(pos + 1);
+        }
+    }
+
+    chunks_.push_back(len + 1);
+
+    /* Compute break points for each paragraph of each chunk */
+    auto numChunks = chunks_.size() - 1;
+    std::vector<std::vector<BreakPoint>> chunkBreakPoints(numChunks);
+
+    ParallelFor(
+        numChunks,
+        [&](std::size_t chunk)
+        {
+            auto& breakPoints = chunkBreakPoints[chunk];
+
+            for (auto start = chunks_[chunk]; start < chunks_[chunk + 1]; )
+            {
+                /* Find end of paragraph */
+                auto end = start;
+                while (end < len && !IsNewLine(static_cast<char32_t>(text_[end])))
+                    ++end;
+
+                ComputeLineBreaks(
+                    text_, start, end,
+                    [&breakPoints](SizeType pos)
+                    {
+                        breakPoints.push_back({ pos, 0, false });
+                    }
+                );
+
+                breakPoints.push_back({ end, 0, true });
+                start = end + 1;
+            }
+        }
+    );
+
+    /* Splice break points of all chunks */
+    breakPoints_.clear();
+    chunkBreaks_.clear();
+
+    for (auto& breakPoints : chunkBreakPoints)
+    {
+        chunkBreaks_.push_back(breakPoints_.size());
+        breakPoints_.insert(breakPoints_.end(), breakPoints.begin(), breakPoints.end());
+    }
+
+    chunkBreaks_.push_back(breakPoints_.size());
 }
 
-void MultiLineString::AppendLine()
+template <typename T>
+void BasicMultiLineString<T>::RebuildAdvances()
 {
-    AppendLine(String(), 0);
+    auto len = text_.size();
+    auto numChunks = chunks_.size() - 1;
+
+    advances_.resize(len + 1);
+    advances_[0] = 0;
+
+    /* Accumulate character widths within each chunk, and store the visible width of each break point */
+    std::vector<int> chunkWidths(numChunks);
+
+    ParallelFor(
+        numChunks,
+        [&](std::size_t chunk)
+        {
+            auto breakPoint = breakPoints_.begin() + chunkBreaks_[chunk];
+            auto breakPointEnd = breakPoints_.begin() + chunkBreaks_[chunk + 1];
+
+            int width = 0, visibleWidth = 0;
+
+            for (SizeType pos = chunks_[chunk], next = pos, end = std::min(chunks_[chunk + 1], len); pos < end; pos = next)
+            {
+                auto chr = DecodeCodePoint(text_, next);
+                auto prevWidth = width;
+
+                if (breakPoint != breakPointEnd && breakPoint->position == pos)
+                    (breakPoint++)->width = visibleWidth;
+
+                if (IsNewLine(chr))
+                    visibleWidth = width;
+                else
+                {
+                    width += CharWidth(chr);
+                    if (!IsSpace(chr))
+                        visibleWidth = width;
+                }
+
+                /* Continuation units have the width before the character */
+                for (auto i = pos + 1; i < next; ++i)
+                    advances_[i] = prevWidth;
+
+                advances_[next] = width;
+            }
+
+            /* Store width of the break point at the end of the text */
+            if (breakPoint != breakPointEnd)
+                breakPoint->width = visibleWidth;
+
+            chunkWidths[chunk] = width;
+        }
+    );
+
+    /* Move chunk widths to cumulative widths of the entire text */
+    if (numChunks > 1)
+    {
+        for (std::size_t chunk = 1; chunk < numChunks; ++chunk)
+            chunkWidths[chunk] += chunkWidths[chunk - 1];
+
+        ParallelFor(
+            numChunks - 1,
+            [&](std::size_t i)
+            {
+                auto chunk = i + 1;
+                auto offset = chunkWidths[chunk - 1];
+
+                for (auto pos = chunks_[chunk] + 1, end = std::min(chunks_[chunk + 1], len); pos <= end; ++pos)
+                    advances_[pos] += offset;
+
+                for (auto j = chunkBreaks_[chunk]; j < chunkBreaks_[chunk + 1]; ++j)
+                    breakPoints_[j].width += offset;
+            }
+        );
+    }
 }
 
-void MultiLineString::RebuildLines()
+template <typename T>
+void BasicMultiLineString<T>::RebuildLines()
 {
     /* Reset line strings */
     lines_.clear();
     width_ = 0;
+    ++layoutVersion_;
 
-    /* Start recursion for line appending */
-    if (!text_.empty())
+    if (text_.empty())
+        return;
+
+    /* Wrap all chunks and splice their lines */
+    auto numChunks = chunks_.size() - 1;
+
+    if (numChunks == 1)
+        WrapChunk(0, lines_);
+    else
     {
-        SizeType offset = 0;
-        while (offset <= text_.size())
-            offset = AppendLinesFromSubText(offset);
+        std::vector<std::vector<TextLine>> chunkLines(numChunks);
+
+        ParallelFor(
+            numChunks,
+            [&](std::size_t chunk)
+            {
+                WrapChunk(chunk, chunkLines[chunk]);
+            }
+        );
+
+        std::size_t numLines = 0;
+        for (const auto& lines : chunkLines)
+            numLines += lines.size();
+
+        lines_.reserve(numLines);
+
+        for (auto& lines : chunkLines)
+            std::move(lines.begin(), lines.end(), std::back_inserter(lines_));
     }
+
+    UpdateWidestWidth();
 }
 
-MultiLineString::SizeType MultiLineString::AppendLinesFromSubText(SizeType offset)
+template <typename T>
+void BasicMultiLineString<T>::WrapChunk(SizeType chunk, std::vector<TextLine>& lines) const
 {
-    if (offset > text_.size())
-        return String::npos;
+    auto lineStart = chunks_[chunk];
 
-    int subTextWidth = 0;
+    auto first = breakPoints_.begin() + chunkBreaks_[chunk];
+    auto end = breakPoints_.begin() + chunkBreaks_[chunk + 1];
 
-    SizeType pos = offset;
-    auto posWordEnd = pos;
-    auto len = text_.size();
-    Char prevChr = 0;
-
-    for (; pos < len; ++pos)
+    while (first != end)
     {
-        /* Get current character and its width */
-        auto chr = text_[pos];
-        auto chrWidth = CharWidth(chr);
+        /* Find the end of the current paragraph */
+        auto last = first;
+        while (!last->mandatory)
+            ++last;
 
-        /* Check for new-line character */
-        if (IsNewLine(chr))
+        /* Append all lines of this paragraph */
+        while (first <= last)
         {
-            /* Append sub text without new-line character */
-            return AppendLineFromSubText(offset, pos, subTextWidth) + 1;
-        }
+            /* Find the last break point, which fits into the line */
+            auto lineOrigin = advances_[lineStart];
+            auto it = std::upper_bound(
+                first, last + 1, lineOrigin + maxWidth_,
+                [](int width, const BreakPoint& breakPoint)
+                {
+                    return width < breakPoint.width;
+                }
+            );
+
+            if (it == first)
+            {
+                /* No break point fits -> break line at the last character that fits */
+                auto lineEnd = FitCodePoints(lineStart, first->position);
+                if (lineEnd < first->position)
+                {
+                    lines.push_back({ text_.substr(lineStart, lineEnd - lineStart), advances_[lineEnd] - lineOrigin, lineStart });
+                    lineStart = lineEnd;
+                    continue;
+                }
+                ++it;
+            }
 
-        /* Check if new character fits into the current line */
-        if (FitIntoLine(subTextWidth + chrWidth))
-        {
-            /* Accumulate sub text width */
-            subTextWidth += chrWidth;
-        }
-        else if (posWordEnd == offset)
-        {
-            /* Does not fit -> append line with truncated word */
-            return AppendLineFromSubText(offset, pos, subTextWidth);
-        }
-        else
-        {
-            /* Does not fit -> move back to last non-space character */
-            return AppendLineFromSubText(offset, posWordEnd + 1, subTextWidth);
+            /* Append line until the break point */
+            --it;
+            lines.push_back({ text_.substr(lineStart, it->position - lineStart), it->width - lineOrigin, lineStart });
+
+            /* Continue after the break point (and after the new-line character) */
+            lineStart = (it->mandatory ? it->position + 1 : it->position);
+            first = it + 1;
         }
+    }
+}
+
+template <typename T>
+void BasicMultiLineString<T>::UpdateAttributeSpans(SizeType pos, SizeType removed, SizeType inserted)
+{
+    static const TextAttribute defaultAttribute;
+
+    /* Plain text without any attributes does not need any spans */
+    if (attributeSpans_.empty() && attribute_ == defaultAttribute)
+        return;
+
+    auto oldLength = text_.size();
+    auto newLength = oldLength - removed + inserted;
+
+    /* Without spans, the entire old text has the default attribute */
+    if (attributeSpans_.empty() && oldLength > 0)
+        attributeSpans_.push_back({ 0, defaultAttribute });
+
+    std::vector<TextAttributeSpan> spans;
+    spans.reserve(attributeSpans_.size() + 2);
+
+    auto AppendSpan = [&spans](SizeType offset, const TextAttribute& attribute)
+    {
+        /* Merge equal neighbors */
+        if (spans.empty() || spans.back().attribute != attribute)
+            spans.push_back({ offset, attribute });
+    };
+
+    /* Keep spans before the replaced range */
+    auto it = attributeSpans_.begin(), end = attributeSpans_.end();
+    for (; it != end && it->offset < pos; ++it)
+        AppendSpan(it->offset, it->attribute);
+
+    /* Insert span for the new characters */
+    if (inserted > 0)
+        AppendSpan(pos, attribute_);
+
+    /* Continue with the span which contains the end of the replaced range, and move all spans after it */
+    auto restPos = pos + removed;
+    if (restPos < oldLength)
+    {
+        auto prev = (it != attributeSpans_.begin() ? it - 1 : it);
+        while (it != end && it->offset <= restPos)
+            prev = it++;
 
-        /* Store position after the last non-space character of the last complete word */
-        if (IsSpace(chr) && !IsSpace(prevChr))
-            posWordEnd = pos;
+        AppendSpan(pos + inserted, prev->attribute);
 
-        /* Store previous character */
-        prevChr = chr;
+        for (; it != end; ++it)
+            AppendSpan(it->offset - removed + inserted, it->attribute);
     }
 
-    /* Append last line */
-    return AppendLineFromSubText(offset, pos, subTextWidth) + 1;
+    /* Drop spans again, if the entire text has the default attribute */
+    if (newLength == 0 || (spans.size() == 1 && spans.front().attribute == defaultAttribute))
+        spans.clear();
+
+    attributeSpans_ = std::move(spans);
 }
 
-MultiLineString::SizeType MultiLineString::AppendLineFromSubText(SizeType start, SizeType end, int subTextWidth)
+template <typename T>
+typename BasicMultiLineString<T>::SizeType BasicMultiLineString<T>::FitCodePoints(SizeType start, SizeType end) const
 {
-    if (start <= end)
-        AppendLine(text_.substr(start, end - start), subTextWidth);
-    return end;
+    /* Accept at least one character */
+    auto lineOrigin = advances_[start];
+    auto pos = NextCodePoint(text_, start);
+
+    while (pos < end)
+    {
+        auto next = NextCodePoint(text_, pos);
+        if (!FitIntoLine(advances_[next] - lineOrigin))
+            break;
+        pos = next;
+    }
+
+    return pos;
 }
 
+template class BasicMultiLineString<char>;
+template class BasicMultiLineString<char16_t>;
+template class BasicMultiLineString<char32_t>;
+template class BasicMultiLineString<wchar_t>;
+
 
 } // /namespace Tg
 
@@ -0,0 +1,77 @@
+/*
+ * ParallelFor.h
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef TG_PARALLEL_FOR_H
+#define TG_PARALLEL_FOR_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+namespace Tg
+{
+
+
+//! Returns the number of threads for parallel tasks (at least 1).
+inline std::size_t GetNumWorkerThreads()
+{
+    static const std::size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    return numThreads;
+}
+
+/**
+\brief Calls the specified function for each task index in the range [0, numTasks) in parallel.
+\remarks The calling thread works on the tasks as well, and this function returns when all tasks are done.
+Tasks are handed out in ascending order, but they may finish in any order. If there is only one task or one thread, no thread is created.
+The function must not throw any exceptions.
+*/
+template <typename Func>
+void ParallelFor(std::size_t numTasks, const Func& func)
+{
+    auto numThreads = std::min(numTasks, GetNumWorkerThreads());
+
+    if (numThreads <= 1)
+    {
+        for (std::size_t i = 0; i < numTasks; ++i)
+            func(i);
+        return;
+    }
+
+    /* Let all threads fetch the next task index */
+    std::atomic<std::size_t> nextTask { 0 };
+
+    auto worker = [&]()
+    {
+        for (auto i = nextTask++; i < numTasks; i = nextTask++)
+            func(i);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+
+    for (std::size_t i = 1; i < numThreads; ++i)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+
+} // /namespace Tg
+
+
+#endif
+
+
+
+// ================================================================================
@@ -13,14 +13,54 @@ namespace Tg
 {
 
 
-Terminal::Terminal(const FontGlyphSet& glyphSet, int maxWidth) :
-    textField  { glyphSet, maxWidth, ""           },
-    streamBuf_ { new TerminalStreamBuf(textField) },
-    in         { streamBuf_.get()                 },
-    out        { streamBuf_.get()                 }
+Terminal::Terminal(const FontGlyphSet& glyphSet, int maxWidth, std::size_t postQueueCapacity) :
+    textField  { glyphSet, maxWidth, String()                        },
+    streamBuf_ { new TerminalStreamBuf(textField, postQueueCapacity) },
+    in         { streamBuf_.get()                                    },
+    out        { streamBuf_.get()                                    }
 {
 }
 
+bool Terminal::Post(const std::string& text)
+{
+    return GetStreamBuf()->Post(text);
+}
+
+std::size_t Terminal::Drain()
+{
+    return GetStreamBuf()->Drain();
+}
+
+std::size_t Terminal::GetNumDroppedPosts() const
+{
+    return GetStreamBuf()->GetNumDroppedPosts();
+}
+
+std::size_t Terminal::GetNumDroppedChars() const
+{
+    return GetStreamBuf()->GetNumDroppedChars();
+}
+
+void Terminal::CommitInput()
+{
+    GetStreamBuf()->CommitInput();
+    in.clear();
+}
+
+void Terminal::SetScrollbackLimit(std::size_t maxLines, std::size_t maxLength)
+{
+    GetStreamBuf()->SetScrollbackLimit(maxLines, maxLength);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+TerminalStreamBuf* Terminal::GetStreamBuf() const
+{
+    return static_cast<TerminalStreamBuf*>(streamBuf_.get());
+}
 
 
 } // /namespace Tg
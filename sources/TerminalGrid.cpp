@@ -0,0 +1,376 @@
+/*
+ * TerminalGrid.cpp
+ *
+ * This file is part of the "TypographiaLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Typo/TerminalGrid.h>
+#include <Typo/Unicode.h>
+#include "EscapeSequenceParser.h"
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace Tg
+{
+
+
+/*
+ * TerminalGridStreamBuf class
+ */
+
+//! Stream buffer for the terminal grid output, which decodes UTF-8 and parses escape sequences.
+class TerminalGridStreamBuf : public std::streambuf, private EscapeSequenceHandler
+{
+
+    public:
+
+        TerminalGridStreamBuf(TerminalGrid& grid) :
+            grid_    { grid        },
+            putArea_ ( putAreaSize )
+        {
+            setp(putArea_.data(), putArea_.data() + putArea_.size());
+        }
+
+        int_type overflow(int_type c) override
+        {
+            FlushPutArea();
+
+            if (c != traits_type::eof())
+            {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char_type* s, std::streamsize n) override
+        {
+            if (n <= epptr() - pptr())
+            {
+                traits_type::copy(pptr(), s, static_cast<std::size_t>(n));
+                pbump(static_cast<int>(n));
+            }
+            else
+            {
+                FlushPutArea();
+                parser_.Parse(s, static_cast<std::size_t>(n), *this);
+            }
+            return n;
+        }
+
+        int sync() override
+        {
+            FlushPutArea();
+            return 0;
+        }
+
+    private:
+
+        static const std::size_t putAreaSize = 4096;
+
+        void FlushPutArea()
+        {
+            if (pptr() > pbase())
+                parser_.Parse(pbase(), static_cast<std::size_t>(pptr() - pbase()), *this);
+            setp(putArea_.data(), putArea_.data() + putArea_.size());
+        }
+
+        void OnText(const char* text, std::size_t length) override
+        {
+            std::size_t pos = 0;
+
+            /* Complete the character, which has been split at the end of the previous text run */
+            if (numPending_ > 0)
+            {
+                auto seqLength = UTF8SequenceLength(static_cast<unsigned char>(pending_[0]));
+                while (numPending_ < seqLength && pos < length && IsContinuationUnit(text[pos]))
+                    pending_[numPending_++] = text[pos++];
+
+                if (numPending_ < seqLength && pos == length)
+                    return;
+
+                for (std::size_t i = 0; i < numPending_;)
+                    PutChar(DecodeCodePoint(pending_, numPending_, i));
+
+                numPending_ = 0;
+            }
+
+            /* Keep an incomplete character at the end of the text run */
+            auto end = length;
+
+            for (auto i = length; i > pos && length - i < 4;)
+            {
+                --i;
+                if (!IsContinuationUnit(text[i]))
+                {
+                    if (UTF8SequenceLength(static_cast<unsigned char>(text[i])) > length - i)
+                        end = i;
+                    break;
+                }
+            }
+
+            while (pos < end)
+                PutChar(DecodeCodePoint(text, end, pos));
+
+            std::copy(text + end, text + length, pending_);
+            numPending_ = length - end;
+        }
+
+        void OnCarriageReturn() override
+        {
+            grid_.SetCursor(0, grid_.GetCursorRow());
+        }
+
+        void OnControlSequence(char command, const int* params, std::size_t numParams) override
+        {
+            grid_.ExecuteControlSequence(command, params, numParams);
+        }
+
+        void PutChar(char32_t chr)
+        {
+            switch (chr)
+            {
+                case U'\n':
+                    grid_.LineFeed();
+                    break;
+
+                case U'\b':
+                    if (grid_.GetCursorColumn() > 0)
+                        grid_.SetCursor(grid_.GetCursorColumn() - 1, grid_.GetCursorRow());
+                    break;
+
+                case U'\t':
+                    /* Fill spaces until the next tab stop (every 8 columns) */
+                    do
+                    {
+                        grid_.PutChar(U' ');
+                    }
+                    while (grid_.GetCursorColumn() % 8 != 0 && grid_.GetCursorColumn() < grid_.GetNumColumns());
+                    break;
+
+                default:
+                    /* Ignore all other control characters */
+                    if (chr >= 0x20 && chr != 0x7F)
+                        grid_.PutChar(chr);
+                    break;
+            }
+        }
+
+        TerminalGrid&           grid_;
+
+        std::vector<char_type>  putArea_;
+        EscapeSequenceParser    parser_;
+
+        char                    pending_[4];
+        std::size_t             numPending_ = 0;
+
+};
+
+
+/*
+ * TerminalGrid class
+ */
+
+TerminalGrid::TerminalGrid(const FontGlyphSet& glyphSet, std::size_t numColumns, std::size_t numRows) :
+    glyphSet_  { &glyphSet                         },
+    cellWidth_ { glyphSet.GetMonospaceAdvance()    },
+    streamBuf_ { new TerminalGridStreamBuf(*this) },
+    out        { streamBuf_.get()                  }
+{
+    if (cellWidth_ == 0)
+        throw std::runtime_error("terminal grid requires a monospace glyph set");
+    Resize(numColumns, numRows);
+}
+
+TerminalGrid::~TerminalGrid()
+{
+}
+
+void TerminalGrid::Write(const std::string& text)
+{
+    out << text << std::flush;
+}
+
+void TerminalGrid::Resize(std::size_t numColumns, std::size_t numRows)
+{
+    numColumns = std::max(numColumns, std::size_t(1));
+    numRows = std::max(numRows, std::size_t(1));
+
+    /* Drop top rows, if the cursor row would be outside the new grid */
+    auto shift = (cursorRow_ >= numRows ? cursorRow_ - numRows + 1 : 0);
+
+    std::vector<TerminalCell> cells(numColumns * numRows);
+
+    if (!cells_.empty())
+    {
+        /* Copy overlapping cells, and store the rows in order */
+        auto copyColumns = std::min(numColumns, numColumns_);
+        for (std::size_t row = 0; row < numRows && row + shift < numRows_; ++row)
+        {
+            auto src = GetRow(row + shift);
+            std::copy(src, src + copyColumns, cells.begin() + row * numColumns);
+        }
+    }
+
+    cells_          = std::move(cells);
+    numColumns_     = numColumns;
+    numRows_        = numRows;
+    firstRow_       = 0;
+    cursorColumn_   = std::min(cursorColumn_, numColumns_);
+    cursorRow_      -= shift;
+}
+
+void TerminalGrid::Clear()
+{
+    std::fill(cells_.begin(), cells_.end(), TerminalCell());
+    firstRow_       = 0;
+    cursorColumn_   = 0;
+    cursorRow_      = 0;
+}
+
+void TerminalGrid::ScrollUp(std::size_t numRows)
+{
+    /* Rotate rows, and clear each row which becomes the new bottom row */
+    for (numRows = std::min(numRows, numRows_); numRows > 0; --numRows)
+    {
+        firstRow_ = (firstRow_ + 1) % numRows_;
+        EraseCells(numRows_ - 1, 0, numColumns_);
+    }
+}
+
+const TerminalCell* TerminalGrid::GetRow(std::size_t row) const
+{
+    return &cells_[((firstRow_ + row) % numRows_) * numColumns_];
+}
+
+void TerminalGrid::SetCursor(std::size_t column, std::size_t row)
+{
+    cursorColumn_   = std::min(column, numColumns_ - 1);
+    cursorRow_      = std::min(row, numRows_ - 1);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void TerminalGrid::PutChar(char32_t chr)
+{
+    /* Wrap to the next row, if the previous character has been written into the last column */
+    if (cursorColumn_ >= numColumns_)
+        LineFeed();
+
+    GetMutableRow(cursorRow_)[cursorColumn_] = TerminalCell(chr, attribute_);
+    ++cursorColumn_;
+}
+
+void TerminalGrid::LineFeed()
+{
+    cursorColumn_ = 0;
+    if (cursorRow_ + 1 < numRows_)
+        ++cursorRow_;
+    else
+        ScrollUp(1);
+}
+
+void TerminalGrid::ExecuteControlSequence(char command, const int* params, std::size_t numParams)
+{
+    /* Returns the specified parameter or the default value if it is omitted or 0 */
+    auto Param = [params, numParams](std::size_t index, int defaultValue) -> std::size_t
+    {
+        return static_cast<std::size_t>(index < numParams && params[index] > 0 ? params[index] : defaultValue);
+    };
+
+    auto column = std::min(cursorColumn_, numColumns_ - 1);
+
+    switch (command)
+    {
+        case 'm': // SGR
+            ApplySGR(attribute_, params, numParams);
+            break;
+
+        case 'A': // CUU
+            SetCursor(column, cursorRow_ - std::min(cursorRow_, Param(0, 1)));
+            break;
+
+        case 'B': // CUD
+            SetCursor(column, cursorRow_ + Param(0, 1));
+            break;
+
+        case 'C': // CUF
+            SetCursor(column + Param(0, 1), cursorRow_);
+            break;
+
+        case 'D': // CUB
+            SetCursor(column - std::min(column, Param(0, 1)), cursorRow_);
+            break;
+
+        case 'G': // CHA
+            SetCursor(Param(0, 1) - 1, cursorRow_);
+            break;
+
+        case 'H': // CUP
+        case 'f': // HVP
+            SetCursor(Param(1, 1) - 1, Param(0, 1) - 1);
+            break;
+
+        case 'J': // ED
+        {
+            auto mode = (numParams > 0 ? params[0] : 0);
+            if (mode == 0)
+            {
+                EraseCells(cursorRow_, column, numColumns_);
+                for (auto row = cursorRow_ + 1; row < numRows_; ++row)
+                    EraseCells(row, 0, numColumns_);
+            }
+            else if (mode == 1)
+            {
+                for (std::size_t row = 0; row < cursorRow_; ++row)
+                    EraseCells(row, 0, numColumns_);
+                EraseCells(cursorRow_, 0, column + 1);
+            }
+            else if (mode == 2 || mode == 3)
+            {
+                for (std::size_t row = 0; row < numRows_; ++row)
+                    EraseCells(row, 0, numColumns_);
+            }
+        }
+        break;
+
+        case 'K': // EL
+        {
+            auto mode = (numParams > 0 ? params[0] : 0);
+            if (mode == 0)
+                EraseCells(cursorRow_, column, numColumns_);
+            else if (mode == 1)
+                EraseCells(cursorRow_, 0, column + 1);
+            else if (mode == 2)
+                EraseCells(cursorRow_, 0, numColumns_);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+void TerminalGrid::EraseCells(std::size_t row, std::size_t first, std::size_t last)
+{
+    auto cells = GetMutableRow(row);
+    std::fill(cells + first, cells + last, TerminalCell(U' ', attribute_));
+}
+
+TerminalCell* TerminalGrid::GetMutableRow(std::size_t row)
+{
+    return &cells_[((firstRow_ + row) % numRows_) * numColumns_];
+}
+
+
+} // /namespace Tg
+
+
+
+// ================================================================================
@@ -6,61 +6,349 @@
  */
 
 #include "TerminalStreamBuf.h"
+#include <algorithm>
 
 
 namespace Tg
 {
 
 
-TerminalStreamBuf::TerminalStreamBuf(TextFieldMultiLineString& textField) :
-    textField_ { textField }
+// Size of the put area (in characters)
+static const std::size_t putAreaSize = 4096;
+
+TerminalStreamBuf::TerminalStreamBuf(TextFieldMultiLineString& textField, std::size_t postQueueCapacity) :
+    textField_ { textField         },
+    putArea_   ( putAreaSize       ),
+    postQueue_ { postQueueCapacity }
 {
     textField_.insertionEnabled = true;
+    setp(putArea_.data(), putArea_.data() + putArea_.size());
 }
 
 TerminalStreamBuf::int_type TerminalStreamBuf::overflow(int_type c)
 {
+    FlushPutArea();
+
     if (c != traits_type::eof())
     {
-        auto chr = traits_type::to_char_type(c);
-        if (chr == '\r')
-            textField_.MoveCursorBegin();
-        else
-            textField_.Put(chr);
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+std::streamsize TerminalStreamBuf::xsputn(const char_type* s, std::streamsize n)
+{
+    if (n <= epptr() - pptr())
+    {
+        /* Append characters to the put area */
+        traits_type::copy(pptr(), s, static_cast<std::size_t>(n));
+        pbump(static_cast<int>(n));
+    }
+    else
+    {
+        /* Write large strings directly into the text field */
+        FlushPutArea();
+        WriteChars(s, static_cast<std::size_t>(n));
     }
-    return c;
+    return n;
+}
+
+int TerminalStreamBuf::sync()
+{
+    FlushPutArea();
+    return 0;
+}
+
+bool TerminalStreamBuf::Post(const std::string& text)
+{
+    /* Copy text on the producer thread, so the consumer only moves it */
+    auto str = text;
+    if (postQueue_.TryPush(std::move(str)))
+        return true;
+
+    /* Queue is full -> drop text */
+    numDroppedPosts_.fetch_add(1, std::memory_order_relaxed);
+    numDroppedChars_.fetch_add(text.size(), std::memory_order_relaxed);
+
+    return false;
 }
 
-#if 0
+std::size_t TerminalStreamBuf::Drain()
+{
+    /* Keep the order of the output stream and the posted texts */
+    FlushPutArea();
+
+    /*
+    Concatenate all posted texts, but at most one queue capacity,
+    so producers that keep posting can not delay the consumer forever
+    */
+    drainBuffer_.clear();
+
+    std::size_t numPosts = 0;
+    std::string text;
 
-int_type underflow() override
+    while (numPosts < postQueue_.Capacity() && postQueue_.TryPop(text))
+    {
+        drainBuffer_ += text;
+        ++numPosts;
+    }
+
+    /* Write all texts into the text field at once */
+    if (!drainBuffer_.empty())
+        WriteChars(drainBuffer_.data(), drainBuffer_.size());
+
+    return numPosts;
+}
+
+void TerminalStreamBuf::SetScrollbackLimit(std::size_t maxLines, std::size_t maxLength)
 {
-    if (inCount_ == 0)
-        return traits_type::eof();
-    return traits_type::to_int_type('A');
+    maxLines_   = maxLines;
+    maxLength_  = maxLength;
+
+    /* Trim text field to the exact limit */
+    FlushPutArea();
+    TrimTextField();
 }
 
-int_type uflow() override
+void TerminalStreamBuf::CommitInput()
 {
-    if (inCount_ == 0)
-        return traits_type::eof();
-    --inCount_;
-    return traits_type::to_int_type('B');
+    /* Write pending output first, so the input begins after it */
+    FlushPutArea();
+
+    /* Take all text after the last output as input line (one code unit per character, as for the output) */
+    const auto& text = textField_.GetText();
+    auto start = std::min(inputStart_, text.size());
+
+    std::string line;
+    line.reserve(text.size() - start + 1);
+
+    for (auto pos = start; pos < text.size(); ++pos)
+        line += static_cast<char_type>(text[pos]);
+
+    line += '\n';
+
+    /* Echo the new-line character, which ends the input line */
+    textField_.MoveCursorBottom();
+    textField_.MoveCursorEnd();
+    WriteChars("\n", 1);
+
+    /* Append line to the input buffer and discard the characters which have already been read */
+    if (eback() != nullptr)
+        inputBuffer_.erase(0, static_cast<std::size_t>(gptr() - eback()));
+
+    inputBuffer_ += line;
+
+    auto begin = &inputBuffer_[0];
+    setg(begin, begin, begin + inputBuffer_.size());
+}
+
+TerminalStreamBuf::int_type TerminalStreamBuf::underflow()
+{
+    /* The get area always spans all committed input, so it is only empty if nothing is available */
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+    return traits_type::eof();
+}
+
+std::streamsize TerminalStreamBuf::showmanyc()
+{
+    /* More input may be committed later, so never indicate the end of the stream */
+    return 0;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void TerminalStreamBuf::FlushPutArea()
+{
+    WriteChars(pbase(), static_cast<std::size_t>(pptr() - pbase()));
+    setp(putArea_.data(), putArea_.data() + putArea_.size());
+}
+
+void TerminalStreamBuf::WriteChars(const char_type* s, std::size_t n)
+{
+    if (n == 0)
+        return;
+
+    /* Pass text runs between escape sequences to the text field ('\b' is handled by the text field) */
+    parser_.Parse(s, n, *this);
+
+    /* The user input begins after the output */
+    inputStart_ = textField_.GetCursorPosition();
+
+    TrimScrollback();
 }
 
-int_type pbackfail(int_type ch) override
+void TerminalStreamBuf::OnText(const char* text, std::size_t length)
 {
-    if (inCount_ == 0)
-        return traits_type::eof();
-    return traits_type::to_int_type('C');
+    textField_.Put(String(text, text + length));
 }
 
-std::streamsize showmanyc() override
+void TerminalStreamBuf::OnCarriageReturn()
 {
-    return inCount_;
+    textField_.MoveCursorBegin();
 }
 
-#endif
+void TerminalStreamBuf::OnControlSequence(char command, const int* params, std::size_t numParams)
+{
+    /* Returns the specified parameter or the default value if it is omitted or 0 */
+    auto Param = [params, numParams](std::size_t index, int defaultValue) -> std::size_t
+    {
+        return static_cast<std::size_t>(index < numParams && params[index] > 0 ? params[index] : defaultValue);
+    };
+
+    auto lineIndex = textField_.GetCursorCoordinate().y;
+
+    switch (command)
+    {
+        case 'm': // SGR
+        {
+            auto attribute = textField_.GetAttribute();
+            ApplySGR(attribute, params, numParams);
+            textField_.SetAttribute(attribute);
+        }
+        break;
+
+        case 'A': // CUU
+            MoveCursorTo(GetCursorColumn(), lineIndex - std::min(lineIndex, Param(0, 1)));
+            break;
+
+        case 'B': // CUD
+            MoveCursorTo(GetCursorColumn(), lineIndex + Param(0, 1));
+            break;
+
+        case 'C': // CUF
+            MoveCursorTo(GetCursorColumn() + Param(0, 1), lineIndex);
+            break;
+
+        case 'D': // CUB
+            MoveCursorTo(GetCursorColumn() - std::min(GetCursorColumn(), Param(0, 1)), lineIndex);
+            break;
+
+        case 'G': // CHA
+            MoveCursorTo(Param(0, 1) - 1, lineIndex);
+            break;
+
+        case 'H': // CUP
+        case 'f': // HVP
+            MoveCursorTo(Param(1, 1) - 1, Param(0, 1) - 1);
+            break;
+
+        case 'K': // EL
+            EraseLine(numParams > 0 ? params[0] : 0);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void TerminalStreamBuf::MoveCursorTo(std::size_t column, std::size_t lineIndex)
+{
+    const auto& lines = textField_.GetLines();
+    if (lines.empty())
+        return;
+
+    /* Convert column into code units (clamped to the end of the line) */
+    lineIndex = std::min(lineIndex, lines.size() - 1);
+    const auto& lineText = lines[lineIndex].text;
+
+    String::size_type pos = 0;
+    for (; column > 0 && pos < lineText.size(); --column)
+        pos = NextCodePoint(lineText, pos);
+
+    /* Move cursor without selecting any text */
+    auto selEnabled = textField_.selectionEnabled;
+    {
+        textField_.selectionEnabled = false;
+        textField_.SetCursorCoordinate(pos, lineIndex);
+    }
+    textField_.selectionEnabled = selEnabled;
+}
+
+std::size_t TerminalStreamBuf::GetCursorColumn() const
+{
+    auto coord = textField_.GetCursorCoordinate();
+    const auto& lineText = textField_.GetLine(coord.y).text;
+
+    std::size_t column = 0;
+    for (String::size_type pos = 0; pos < coord.x; pos = NextCodePoint(lineText, pos))
+        ++column;
+
+    return column;
+}
+
+void TerminalStreamBuf::EraseLine(int mode)
+{
+    const auto& lines = textField_.GetLines();
+    if (lines.empty())
+        return;
+
+    auto cursorPos = textField_.GetCursorPosition();
+    const auto& line = lines[textField_.GetCursorCoordinate().y];
+
+    auto lineBegin = line.offset;
+    auto lineEnd = line.offset + line.text.size();
+
+    auto selEnabled = textField_.selectionEnabled;
+    auto insEnabled = textField_.insertionEnabled;
+
+    if (mode == 0)
+    {
+        /* Erase from the cursor to the end of the line */
+        textField_.SetSelection(cursorPos, lineEnd);
+        textField_.RemoveSelection();
+    }
+    else if (mode == 1)
+    {
+        /* Overwrite all characters before the cursor with spaces, so the cursor keeps its column */
+        auto column = GetCursorColumn();
+        textField_.SetSelection(lineBegin, cursorPos);
+        textField_.RemoveSelection();
+        textField_.insertionEnabled = false;
+        textField_.Put(String(column, Char(' ')));
+    }
+    else if (mode == 2)
+    {
+        /* Erase entire line and move the cursor to the beginning of the line */
+        textField_.SetSelection(lineBegin, lineEnd);
+        textField_.RemoveSelection();
+    }
+
+    textField_.selectionEnabled = selEnabled;
+    textField_.insertionEnabled = insEnabled;
+}
+
+/*
+Trimming the text field moves the remaining text to the front, so the limit may be exceeded by one eighth,
+before the text field is trimmed back to the limit. This amortizes the cost of dropping lines over the appended lines.
+*/
+static bool ExceedsScrollbackLimit(std::size_t size, std::size_t limit)
+{
+    return (limit > 0 && size > limit + limit / 8);
+}
+
+void TerminalStreamBuf::TrimScrollback()
+{
+    if ( ExceedsScrollbackLimit(textField_.GetLines().size(), maxLines_) ||
+         ExceedsScrollbackLimit(textField_.GetText().size(), maxLength_) )
+    {
+        TrimTextField();
+    }
+}
+
+void TerminalStreamBuf::TrimTextField()
+{
+    auto length = textField_.TrimFront(
+        (maxLines_ > 0 ? maxLines_ : String::npos),
+        (maxLength_ > 0 ? maxLength_ : String::npos)
+    );
+    inputStart_ = (inputStart_ > length ? inputStart_ - length : 0);
+}
 
 
 } // /namespace Tg
@@ -11,27 +11,116 @@
 
 #include <Typo/TextFieldMultiLineString.h>
 #include <Typo/Char.h>
+#include "BoundedQueue.h"
+#include "EscapeSequenceParser.h"
+#include <atomic>
 #include <iostream>
+#include <string>
+#include <vector>
 
 
 namespace Tg
 {
 
 
-class TerminalStreamBuf : public std::streambuf
+/**
+\brief Stream buffer for the terminal output and input.
+\remarks All characters are collected in a put area, and written into the text field only when the stream is flushed
+(e.g. with 'std::flush' or 'std::endl') or the put area is full. Each chunk between carriage returns is inserted at once.
+Committed input lines are appended to an input buffer, and the get area always spans all of its unread characters.
+The output is parsed for ANSI escape sequences: SGR sets the text attribute of the text field (see TextAttribute),
+CUU, CUD, CUF, CUB, CHA and CUP move the cursor (rows are the lines of the text field), and EL erases the current line.
+*/
+class TerminalStreamBuf : public std::streambuf, private EscapeSequenceHandler
 {
 
     public:
 
-        TerminalStreamBuf(TextFieldMultiLineString& textField);
+        TerminalStreamBuf(TextFieldMultiLineString& textField, std::size_t postQueueCapacity);
 
         /* --- Base class overloading --- */
 
         int_type overflow(int_type c) override;
 
+        std::streamsize xsputn(const char_type* s, std::streamsize n) override;
+
+        int sync() override;
+
+        int_type underflow() override;
+
+        std::streamsize showmanyc() override;
+
+        /* --- Terminal functions --- */
+
+        //! Enqueues the specified text without blocking (see Terminal::Post). This can be called from any thread.
+        bool Post(const std::string& text);
+
+        //! Writes all posted texts into the text field at once (see Terminal::Drain).
+        std::size_t Drain();
+
+        inline std::size_t GetNumDroppedPosts() const
+        {
+            return numDroppedPosts_.load(std::memory_order_relaxed);
+        }
+
+        inline std::size_t GetNumDroppedChars() const
+        {
+            return numDroppedChars_.load(std::memory_order_relaxed);
+        }
+
+        //! Sets the scrollback limit in lines and code units (0 for no limit) and trims the text field if necessary.
+        void SetScrollbackLimit(std::size_t maxLines, std::size_t maxLength);
+
+        //! Appends the text after the last output as new line to the input buffer (see Terminal::CommitInput).
+        void CommitInput();
+
     private:
 
-        TextFieldMultiLineString& textField_;
+        //! Writes the put area into the text field and resets the put area.
+        void FlushPutArea();
+
+        //! Writes the specified characters into the text field. '\r' moves the cursor to the beginning of the line.
+        void WriteChars(const char_type* s, std::size_t n);
+
+        /* --- Escape sequence handler --- */
+
+        void OnText(const char* text, std::size_t length) override;
+
+        void OnCarriageReturn() override;
+
+        void OnControlSequence(char command, const int* params, std::size_t numParams) override;
+
+        //! Moves the cursor to the specified column (in characters) of the specified line, without selecting any text.
+        void MoveCursorTo(std::size_t column, std::size_t lineIndex);
+
+        //! Returns the column (in characters) of the cursor within its line.
+        std::size_t GetCursorColumn() const;
+
+        //! Erases the specified part of the current line (0 = after the cursor, 1 = before the cursor, 2 = entire line).
+        void EraseLine(int mode);
+
+        //! Drops paragraphs from the front of the text field, once the scrollback limit is exceeded by one eighth.
+        void TrimScrollback();
+
+        //! Trims the text field to the scrollback limit and moves the input start accordingly.
+        void TrimTextField();
+
+        TextFieldMultiLineString&   textField_;
+
+        std::vector<char_type>      putArea_;
+        EscapeSequenceParser        parser_;
+
+        std::size_t                 maxLines_   = 0;
+        std::size_t                 maxLength_  = 0;
+
+        std::size_t                 inputStart_ = 0;    // Position in the text field where the user input begins
+        std::string                 inputBuffer_;
+
+        BoundedQueue<std::string>   postQueue_;
+        std::string                 drainBuffer_;
+
+        std::atomic<std::size_t>    numDroppedPosts_ { 0 };
+        std::atomic<std::size_t>    numDroppedChars_ { 0 };
 
 };
 
@@ -6,6 +6,7 @@
  */
 
 #include <Typo/TextField.h>
+#include <Typo/Unicode.h>
 #include <algorithm>
 #include <iterator>
 
@@ -14,13 +15,15 @@ namespace Tg
 {
 
 
-TextField::~TextField()
+template <typename T>
+BasicTextField<T>::~BasicTextField()
 {
 }
 
 /* --- Cursor operations --- */
 
-void TextField::SetCursorPosition(SizeType position)
+template <typename T>
+void BasicTextField<T>::SetCursorPosition(SizeType position)
 {
     /* Clamp position to the range [0, GetText().size()] */
     cursorPos_ = ClampedPos(position);
@@ -30,37 +33,42 @@ void TextField::SetCursorPosition(SizeType position)
         selStart_ = cursorPos_;
 }
 
-bool TextField::IsCursorBegin() const
+template <typename T>
+bool BasicTextField<T>::IsCursorBegin() const
 {
     return (GetCursorPosition() == 0);
 }
 
-bool TextField::IsCursorEnd() const
+template <typename T>
+bool BasicTextField<T>::IsCursorEnd() const
 {
     return (GetCursorPosition() == GetText().size());
 }
 
-void TextField::JumpLeft()
+template <typename T>
+void BasicTextField<T>::JumpLeft()
 {
-    /* Move left to first non-separator character, then move left to the last non-separator character */
-    while (!IsCursorBegin() && IsSeparator(CharLeft()))
-        MoveCursor(-1);
-    while (!IsCursorBegin() && !IsSeparator(CharLeft()))
-        MoveCursor(-1);
+    /* Find the beginning of the sequence, then move the cursor only once */
+    int numChars = 0;
+    FindSequenceLeft(GetCursorPosition(), numChars);
+    if (numChars > 0)
+        MoveCursor(-numChars);
 }
 
-void TextField::JumpRight()
+template <typename T>
+void BasicTextField<T>::JumpRight()
 {
-    /* Move right to first non-separator character, then move right to the last non-separator character */
-    while (!IsCursorEnd() && IsSeparator(CharRight()))
-        MoveCursor(1);
-    while (!IsCursorEnd() && !IsSeparator(CharRight()))
-        MoveCursor(1);
+    /* Find the end of the sequence, then move the cursor only once */
+    int numChars = 0;
+    FindSequenceRight(GetCursorPosition(), numChars);
+    if (numChars > 0)
+        MoveCursor(numChars);
 }
 
 /* --- Selection --- */
 
-void TextField::SetSelection(SizeType start, SizeType end)
+template <typename T>
+void BasicTextField<T>::SetSelection(SizeType start, SizeType end)
 {
     /* Store (and later reset) current selection state */
     auto selEnabled = selectionEnabled;
@@ -76,7 +84,8 @@ void TextField::SetSelection(SizeType start, SizeType end)
     selectionEnabled = selEnabled;
 }
 
-void TextField::GetSelection(SizeType& start, SizeType& end) const
+template <typename T>
+void BasicTextField<T>::GetSelection(SizeType& start, SizeType& end) const
 {
     start = GetCursorPosition();
     end = selStart_;
@@ -84,62 +93,81 @@ void TextField::GetSelection(SizeType& start, SizeType& end) const
         std::swap(start, end);
 }
 
-void TextField::SelectAll()
+template <typename T>
+void BasicTextField<T>::SelectAll()
 {
     SetSelection(0, GetText().size());
 }
 
-void TextField::Deselect()
+template <typename T>
+void BasicTextField<T>::Deselect()
 {
     selectionEnabled = false;
     SetCursorPosition(GetCursorPosition());
 }
 
-bool TextField::IsSelected() const
+template <typename T>
+bool BasicTextField<T>::IsSelected() const
 {
     return (GetCursorPosition() != selStart_);
 }
 
-bool TextField::IsAllSelected() const
+template <typename T>
+bool BasicTextField<T>::IsAllSelected() const
 {
     SizeType start, end;
     GetSelection(start, end);
     return (start == 0 && end == GetText().size());
 }
 
-String TextField::GetSelectionText() const
+template <typename T>
+typename BasicTextField<T>::StringType BasicTextField<T>::GetSelectionText() const
 {
     SizeType start, end;
     GetSelection(start, end);
-    return (start < end ? GetText().substr(start, end - start) : String());
+    return (start < end ? GetText().substr(start, end - start) : StringType());
 }
 
 /* --- String content --- */
 
-void TextField::RemoveSequenceLeft()
+template <typename T>
+void BasicTextField<T>::RemoveSequenceLeft()
 {
+    if (IsSelected())
+    {
+        /* First remove selection */
+        RemoveSelection();
+    }
+
     /* Remove all characters before the cursor, until the next separator appears */
-    while (!IsCursorBegin() && IsSeparator(CharLeft()))
-        RemoveLeft();
-    while (!IsCursorBegin() && !IsSeparator(CharLeft()))
-        RemoveLeft();
+    int numChars = 0;
+    auto start = FindSequenceLeft(GetCursorPosition(), numChars);
+    RemoveRange(start, GetCursorPosition());
 }
 
-void TextField::RemoveSequenceRight()
+template <typename T>
+void BasicTextField<T>::RemoveSequenceRight()
 {
+    if (IsSelected())
+    {
+        /* First remove selection */
+        RemoveSelection();
+    }
+
     /* Remove all characters after the cursor, until the next separator appears */
-    while (!IsCursorEnd() && IsSeparator(CharRight()))
-        RemoveRight();
-    while (!IsCursorEnd() && !IsSeparator(CharRight()))
-        RemoveRight();
+    int numChars = 0;
+    auto end = FindSequenceRight(GetCursorPosition(), numChars);
+    RemoveRange(GetCursorPosition(), end);
 }
 
-bool TextField::IsInsertionActive() const
+template <typename T>
+bool BasicTextField<T>::IsInsertionActive() const
 {
     return insertionEnabled && !IsCursorEnd() && !IsSelected();
 }
 
-void TextField::Insert(Char chr)
+template <typename T>
+void BasicTextField<T>::Insert(T chr)
 {
     if (IsValidChar(chr))
     {
@@ -159,15 +187,44 @@ void TextField::Insert(Char chr)
     }
 }
 
-void TextField::Put(Char chr)
+template <typename T>
+void BasicTextField<T>::Insert(const StringType& text)
+{
+    /* Filter valid characters */
+    StringType validText;
+    validText.reserve(text.size());
+
+    for (const auto& chr : text)
+    {
+        if (IsValidChar(chr))
+            validText += chr;
+    }
+
+    if (!validText.empty())
+    {
+        /* Replace selection by text */
+        auto wasSelected = IsSelected();
+        if (wasSelected)
+            RemoveSelection();
+
+        /* Insert actual text and move cursor position */
+        InsertText(validText, wasSelected);
+
+        /* Store memento state */
+        StoreMementoForText(validText);
+    }
+}
+
+template <typename T>
+void BasicTextField<T>::Put(T chr)
 {
     /* Disable selection for adding more characters */
     const auto prevSel = selectionEnabled;
     selectionEnabled = false;
     {
-        if (chr == Char('\b'))
+        if (chr == T('\b'))
             RemoveLeft();
-        else if (chr == Char(127))
+        else if (chr == T(127))
             RemoveRight();
         else
             Insert(chr);
@@ -175,30 +232,56 @@ void TextField::Put(Char chr)
     selectionEnabled = prevSel;
 }
 
-void TextField::Put(const String& text)
+template <typename T>
+void BasicTextField<T>::Put(const StringType& text)
 {
-    for (const auto& chr : text)
-        Put(chr);
+    /* Disable selection for adding more characters */
+    const auto prevSel = selectionEnabled;
+    selectionEnabled = false;
+    {
+        /* Insert all characters between the special characters at once */
+        SizeType start = 0;
+
+        for (SizeType i = 0, n = text.size(); i < n; ++i)
+        {
+            auto chr = text[i];
+            if (chr == T('\b') || chr == T(127))
+            {
+                if (start < i)
+                    Insert(text.substr(start, i - start));
+                Put(chr);
+                start = i + 1;
+            }
+        }
+
+        if (start < text.size())
+            Insert(start > 0 ? text.substr(start) : text);
+    }
+    selectionEnabled = prevSel;
 }
 
-void TextField::Clear()
+template <typename T>
+void BasicTextField<T>::Clear()
 {
-    SetText("");
+    SetText(StringType());
 }
 
-bool TextField::IsSeparator(Char chr) const
+template <typename T>
+bool BasicTextField<T>::IsSeparator(T chr) const
 {
     return !((chr >= 'a' && chr <= 'z') || (chr >= 'A' && chr <= 'Z'));
 }
 
 /* --- Memento --- */
 
-void TextField::StoreSelection()
+template <typename T>
+void BasicTextField<T>::StoreSelection()
 {
     selectionStates_.push({ GetCursorPosition(), selStart_ });
 }
 
-void TextField::RestoreSelection()
+template <typename T>
+void BasicTextField<T>::RestoreSelection()
 {
     if (!selectionStates_.empty())
     {
@@ -208,7 +291,8 @@ void TextField::RestoreSelection()
     }
 }
 
-void TextField::SetMementoSize(std::size_t size)
+template <typename T>
+void BasicTextField<T>::SetMementoSize(std::size_t size)
 {
     if (mementoSize_ != size)
     {
@@ -221,7 +305,8 @@ void TextField::SetMementoSize(std::size_t size)
     }
 }
 
-void TextField::StoreMemento()
+template <typename T>
+void BasicTextField<T>::StoreMemento()
 {
     if (mementoSize_ > 0)
     {
@@ -242,7 +327,8 @@ void TextField::StoreMemento()
     }
 }
 
-void TextField::Undo()
+template <typename T>
+void BasicTextField<T>::Undo()
 {
     if (CanUndo())
     {
@@ -252,18 +338,21 @@ void TextField::Undo()
     }
 }
 
-void TextField::Redo()
+template <typename T>
+void BasicTextField<T>::Redo()
 {
     if (CanRedo())
         RestoreMemento(mementoStatesIndex_ + 1);
 }
 
-bool TextField::CanUndo() const
+template <typename T>
+bool BasicTextField<T>::CanUndo() const
 {
     return (mementoStatesIndex_ > 0);
 }
 
-bool TextField::CanRedo() const
+template <typename T>
+bool BasicTextField<T>::CanRedo() const
 {
     return (mementoStatesIndex_ + 1 < mementoStates_.size());
 }
@@ -273,23 +362,102 @@ bool TextField::CanRedo() const
  * ======= Protected: =======
  */
 
-void TextField::UpdateCursorRange()
+template <typename T>
+void BasicTextField<T>::UpdateCursorRange()
 {
     cursorPos_ = ClampedPos(cursorPos_);
     selStart_ = ClampedPos(selStart_);
 }
 
+template <typename T>
+void BasicTextField<T>::ShiftCursorRange(SizeType length)
+{
+    cursorPos_  = (cursorPos_ > length ? cursorPos_ - length : 0);
+    selStart_   = (selStart_ > length ? selStart_ - length : 0);
+}
+
+template <typename T>
+void BasicTextField<T>::InsertText(const StringType& text, bool wasSelected)
+{
+    for (const auto& chr : text)
+    {
+        InsertChar(chr, wasSelected);
+        MoveCursor(1);
+    }
+}
+
 
 /*
  * ======= Private: =======
  */
 
-TextField::SizeType TextField::ClampedPos(SizeType pos) const
+template <typename T>
+typename BasicTextField<T>::SizeType BasicTextField<T>::FindSequenceLeft(SizeType pos, int& numChars) const
+{
+    const auto& text = GetText();
+    numChars = 0;
+
+    /* Skip separators, then skip non-separators (by code points, but only the code unit left of each position is tested) */
+    while (pos > 0 && IsSeparator(text[pos - 1]))
+    {
+        pos = PrevCodePoint(text, pos);
+        ++numChars;
+    }
+
+    while (pos > 0 && !IsSeparator(text[pos - 1]))
+    {
+        pos = PrevCodePoint(text, pos);
+        ++numChars;
+    }
+
+    return pos;
+}
+
+template <typename T>
+typename BasicTextField<T>::SizeType BasicTextField<T>::FindSequenceRight(SizeType pos, int& numChars) const
+{
+    const auto& text = GetText();
+    numChars = 0;
+
+    /* Skip separators, then skip non-separators (by code points, but only the code unit right of each position is tested) */
+    while (pos < text.size() && IsSeparator(text[pos]))
+    {
+        pos = NextCodePoint(text, pos);
+        ++numChars;
+    }
+
+    while (pos < text.size() && !IsSeparator(text[pos]))
+    {
+        pos = NextCodePoint(text, pos);
+        ++numChars;
+    }
+
+    return pos;
+}
+
+template <typename T>
+void BasicTextField<T>::RemoveRange(SizeType start, SizeType end)
+{
+    if (start < end)
+    {
+        /* Select range and remove it at once, then restore selection state */
+        auto selEnabled = selectionEnabled;
+        {
+            SetSelection(start, end);
+            RemoveSelection();
+        }
+        selectionEnabled = selEnabled;
+    }
+}
+
+template <typename T>
+typename BasicTextField<T>::SizeType BasicTextField<T>::ClampedPos(SizeType pos) const
 {
     return std::min(pos, GetText().size());
 }
 
-void TextField::RestoreMemento(std::size_t index)
+template <typename T>
+void BasicTextField<T>::RestoreMemento(std::size_t index)
 {
     if (index < mementoStates_.size())
     {
@@ -302,14 +470,16 @@ void TextField::RestoreMemento(std::size_t index)
     }
 }
 
-TextField::MementoStateList::const_iterator TextField::GetMementoStateIter(std::size_t index) const
+template <typename T>
+typename BasicTextField<T>::MementoStateList::const_iterator BasicTextField<T>::GetMementoStateIter(std::size_t index) const
 {
     auto it = mementoStates_.begin();
     std::advance(it, index);
     return it;
 }
 
-void TextField::StoreMementoForChar(Char chr)
+template <typename T>
+void BasicTextField<T>::StoreMementoForChar(T chr)
 {
     /* Store memento state if a new separator is added after a non-separator */
     if (IsSeparator(chr) && !IsSeparator(prevPutChar_))
@@ -319,6 +489,31 @@ void TextField::StoreMementoForChar(Char chr)
     prevPutChar_ = chr;
 }
 
+template <typename T>
+void BasicTextField<T>::StoreMementoForText(const StringType& text)
+{
+    /* Store only one memento state, if any new separator is added after a non-separator */
+    bool store = false;
+
+    for (const auto& chr : text)
+    {
+        if (IsSeparator(chr) && !IsSeparator(prevPutChar_))
+            store = true;
+        prevPutChar_ = chr;
+    }
+
+    if (store)
+        StoreMemento();
+    else
+        mementoExpired_ = true;
+}
+
+
+template class BasicTextField<char>;
+template class BasicTextField<char16_t>;
+template class BasicTextField<char32_t>;
+template class BasicTextField<wchar_t>;
+
 
 } // /namespace Tg
 
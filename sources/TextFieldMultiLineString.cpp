@@ -7,134 +7,141 @@
 
 #include <Typo/TextFieldMultiLineString.h>
 #include <algorithm>
+#include <limits>
 
 
 namespace Tg
 {
 
 
-TextFieldMultiLineString::TextFieldMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const String& text) :
+template <typename T>
+BasicTextFieldMultiLineString<T>::BasicTextFieldMultiLineString(const FontGlyphSet& glyphSet, int maxWidth, const StringType& text) :
     text_ { glyphSet, maxWidth, text }
 {
 }
 
-TextFieldMultiLineString& TextFieldMultiLineString::operator = (const String& str)
+template <typename T>
+BasicTextFieldMultiLineString<T>& BasicTextFieldMultiLineString<T>::operator = (const StringType& str)
 {
     SetText(str);
     return *this;
 }
 
-TextFieldMultiLineString& TextFieldMultiLineString::operator += (const String& str)
+template <typename T>
+BasicTextFieldMultiLineString<T>& BasicTextFieldMultiLineString<T>::operator += (const StringType& str)
 {
-    for (const auto& chr : str)
-        Insert(chr);
+    this->Insert(str);
     return *this;
 }
 
-TextFieldMultiLineString& TextFieldMultiLineString::operator += (Char chr)
+template <typename T>
+BasicTextFieldMultiLineString<T>& BasicTextFieldMultiLineString<T>::operator += (T chr)
 {
-    Insert(chr);
+    this->Insert(chr);
     return *this;
 }
 
 /* --- Text position conversion --- */
 
-TextFieldMultiLineString::SizeType TextFieldMultiLineString::GetTextIndex(const Point& position) const
+template <typename T>
+typename BasicTextFieldMultiLineString<T>::SizeType BasicTextFieldMultiLineString<T>::GetTextIndex(const Point& position) const
 {
     return text_.GetTextIndex(position.y, position.x);
 }
 
-Point TextFieldMultiLineString::GetTextPosition(SizeType index) const
+template <typename T>
+Point BasicTextFieldMultiLineString<T>::GetTextPosition(SizeType index) const
 {
     SizeType lineIndex = 0, positionInLine = 0;
     text_.GetTextPosition(index, lineIndex, positionInLine);
     return Point(positionInLine, lineIndex);
 }
 
-TextFieldMultiLineString::SizeType TextFieldMultiLineString::GetXPositionFromCoordinate(SizeType coordinateX, std::size_t lineIndex) const
+template <typename T>
+typename BasicTextFieldMultiLineString<T>::SizeType BasicTextFieldMultiLineString<T>::GetXPositionFromCoordinate(SizeType coordinateX, std::size_t lineIndex) const
 {
-    if (lineIndex < GetLines().size())
-    {
-        /* Iterate over line text to find suitable X coordinate by the text width */
-        const auto& text = GetLineText(lineIndex);
-
-        SizeType pos = 0;
-
-        for (auto width = static_cast<long long>(coordinateX); pos < text.size(); ++pos)
-        {
-            /* Reduce width to zero, to find the suitable */
-            auto prevWidth = width;
-            width -= GetGlyphSet()[text[pos]].advance;
-
-            if (width <= 0)
-            {
-                if (prevWidth > -width)
-                    ++pos;
-                break;
-            }
-        }
-
-        return pos;
-    }
-    return 0;
+    auto x = static_cast<int>(std::min<SizeType>(coordinateX, static_cast<SizeType>(std::numeric_limits<int>::max())));
+    return text_.LineHitTest(lineIndex, x);
 }
 
-TextFieldMultiLineString::SizeType TextFieldMultiLineString::GetXCoordinateFromPosition(SizeType positionX, std::size_t lineIndex) const
+template <typename T>
+typename BasicTextFieldMultiLineString<T>::SizeType BasicTextFieldMultiLineString<T>::GetXCoordinateFromPosition(SizeType positionX, std::size_t lineIndex) const
 {
     if (lineIndex < GetLines().size())
     {
-        /* Return text width of the specified line to the X position */
-        return GetGlyphSet().TextWidth(GetLineText(lineIndex), 0, positionX);
+        /* Return text width of the specified line to the X position (lookup of cumulative widths) */
+        return static_cast<SizeType>(text_.LineWidth(lineIndex, positionX));
     }
     return 0;
 }
 
+template <typename T>
+typename BasicTextFieldMultiLineString<T>::SizeType BasicTextFieldMultiLineString<T>::HitTest(int x, int y, int lineHeight) const
+{
+    return text_.HitTest(x, y, lineHeight);
+}
+
 /* --- Cursor operations --- */
 
-void TextFieldMultiLineString::SetCursorCoordinate(Point position)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::SetCursorCoordinate(Point position)
 {
     if (!GetLines().empty())
     {
         position.y = std::min(position.y, GetLines().size() - 1);
-        position.x = std::min(position.x, GetLineText(position.y).size());
-        SetCursorPosition(GetTextIndex(position));
+
+        const auto& text = GetLineText(position.y);
+        position.x = std::min(position.x, text.size());
+
+        /* The end of a wrapped line is already the beginning of the next line, so keep the cursor before its last character */
+        if (position.x > 0 && position.x == text.size() && position.y + 1 < GetLines().size() &&
+            GetTextIndex(position) == GetLines()[position.y + 1].offset)
+        {
+            position.x = PrevCodePoint(text, position.x);
+        }
+
+        this->SetCursorPosition(GetTextIndex(position));
     }
     else
-        SetCursorPosition(0);
+        this->SetCursorPosition(0);
 }
 
-Point TextFieldMultiLineString::GetCursorCoordinate() const
+template <typename T>
+Point BasicTextFieldMultiLineString<T>::GetCursorCoordinate() const
 {
-    return GetTextPosition(GetCursorPosition());
+    return GetCursorCache().coord;
 }
 
-bool TextFieldMultiLineString::IsCursorTop() const
+template <typename T>
+bool BasicTextFieldMultiLineString<T>::IsCursorTop() const
 {
     return (GetLines().empty() || GetCursorCoordinate().y == 0);
 }
 
-bool TextFieldMultiLineString::IsCursorBottom() const
+template <typename T>
+bool BasicTextFieldMultiLineString<T>::IsCursorBottom() const
 {
     return (GetLines().empty() || GetCursorCoordinate().y + 1 == GetLines().size());
 }
 
-void TextFieldMultiLineString::MoveCursor(int direction)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::MoveCursor(int direction)
 {
-    if (direction < 0)
-    {
-        auto dir = static_cast<SizeType>(-direction);
-        SetCursorPosition(GetCursorPosition() - std::min(dir, GetCursorPosition()));
-    }
-    else if (direction > 0)
-    {
-        auto dir = static_cast<SizeType>(direction);
-        SetCursorPosition(std::min(GetText().size(), GetCursorPosition() + dir));
-    }
+    /* Move cursor character by character, so that it never stops within a character */
+    auto pos = this->GetCursorPosition();
+
+    for (; direction < 0 && pos > 0; ++direction)
+        pos = PrevCodePoint(GetText(), pos);
+    for (; direction > 0 && pos < GetText().size(); --direction)
+        pos = NextCodePoint(GetText(), pos);
+
+    this->SetCursorPosition(pos);
 
     StoreCursorCoordX();
 }
 
-void TextFieldMultiLineString::MoveCursorLine(int direction)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::MoveCursorLine(int direction)
 {
     /* Get number of lines and quit if moving cursor is not possible */
     auto count = GetLines().size();
@@ -174,12 +181,13 @@ void TextFieldMultiLineString::MoveCursorLine(int direction)
 }
 
 //!INCOMPLETE! (due to trunaced spaces at an implicit line break)
-void TextFieldMultiLineString::MoveCursorBegin()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::MoveCursorBegin()
 {
     if (wrapLines)
     {
         /* Move cursor left until the left sided character is a new-line character */
-        while (!IsCursorBegin())
+        while (!this->IsCursorBegin())
         {
             SetCursorCoordinate(0, GetCursorCoordinate().y);
             if (!text_.IsNewLine(CharLeft()))
@@ -195,12 +203,13 @@ void TextFieldMultiLineString::MoveCursorBegin()
 }
 
 //!INCOMPLETE! (due to trunaced spaces at an implicit line break)
-void TextFieldMultiLineString::MoveCursorEnd()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::MoveCursorEnd()
 {
     if (wrapLines)
     {
         /* Move cursor right until the right sided character is a new-line character */
-        while (!IsCursorEnd())
+        while (!this->IsCursorEnd())
         {
             SetCursorCoordinate(GetLineText().size(), GetCursorCoordinate().y);
             if (!text_.IsNewLine(CharRight()))
@@ -215,18 +224,21 @@ void TextFieldMultiLineString::MoveCursorEnd()
     StoreCursorCoordX();
 }
 
-void TextFieldMultiLineString::MoveCursorTop()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::MoveCursorTop()
 {
     RestoreCursorCoordX(0);
 }
 
-void TextFieldMultiLineString::MoveCursorBottom()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::MoveCursorBottom()
 {
     if (!GetLines().empty())
         RestoreCursorCoordX(GetLines().size() - 1);
 }
 
-void TextFieldMultiLineString::JumpUp()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::JumpUp()
 {
     /* Move up to the first non-empty line, then move up to the last non-empty line */
     while (!IsCursorTop() && IsUpperLineEmpty())
@@ -235,7 +247,8 @@ void TextFieldMultiLineString::JumpUp()
         MoveCursorLine(-1);
 }
 
-void TextFieldMultiLineString::JumpDown()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::JumpDown()
 {
     /* Move down to the first non-empty line, then move down to the last non-empty line */
     while (!IsCursorBottom() && IsLowerLineEmpty())
@@ -246,15 +259,17 @@ void TextFieldMultiLineString::JumpDown()
 
 /* --- Selection operations --- */
 
-void TextFieldMultiLineString::SetSelectionCoordinate(const Point& start, const Point& end)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::SetSelectionCoordinate(const Point& start, const Point& end)
 {
-    SetSelection(GetTextIndex(start), GetTextIndex(end));
+    this->SetSelection(GetTextIndex(start), GetTextIndex(end));
 }
 
-void TextFieldMultiLineString::GetSelectionCoordinate(Point& start, Point& end) const
+template <typename T>
+void BasicTextFieldMultiLineString<T>::GetSelectionCoordinate(Point& start, Point& end) const
 {
     SizeType startPos = 0, endPos = 0;
-    GetSelection(startPos, endPos);
+    this->GetSelection(startPos, endPos);
 
     start = GetTextPosition(startPos);
     end = GetTextPosition(endPos);
@@ -262,24 +277,27 @@ void TextFieldMultiLineString::GetSelectionCoordinate(Point& start, Point& end)
 
 /* --- String content --- */
 
-Char TextFieldMultiLineString::CharLeft() const
+template <typename T>
+T BasicTextFieldMultiLineString<T>::CharLeft() const
 {
-    return (!IsCursorBegin() ? GetText()[GetCursorPosition() - 1] : Char(0));
+    return (!this->IsCursorBegin() ? GetText()[this->GetCursorPosition() - 1] : T(0));
 }
 
-Char TextFieldMultiLineString::CharRight() const
+template <typename T>
+T BasicTextFieldMultiLineString<T>::CharRight() const
 {
-    return (!IsCursorEnd() ? GetText()[GetCursorPosition()] : Char(0));
+    return (!this->IsCursorEnd() ? GetText()[this->GetCursorPosition()] : T(0));
 }
 
-void TextFieldMultiLineString::RemoveLeft()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::RemoveLeft()
 {
-    if (IsSelected())
+    if (this->IsSelected())
     {
         /* First remove selection */
         RemoveSelection();
     }
-    else if (!IsCursorBegin())
+    else if (!this->IsCursorBegin())
     {
         /* Move cursor left and then remove character */
         MoveCursor(-1);
@@ -288,14 +306,15 @@ void TextFieldMultiLineString::RemoveLeft()
     }
 }
 
-void TextFieldMultiLineString::RemoveRight()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::RemoveRight()
 {
-    if (IsSelected())
+    if (this->IsSelected())
     {
         /* First remove selection */
         RemoveSelection();
     }
-    else if (!IsCursorEnd())
+    else if (!this->IsCursorEnd())
     {
         /* Only remove character without moving the cursor */
         auto cursorCoord = GetCursorCoordinate();
@@ -303,44 +322,47 @@ void TextFieldMultiLineString::RemoveRight()
     }
 }
 
-void TextFieldMultiLineString::RemoveSelection()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::RemoveSelection()
 {
     /* Remove characters from the start position */
-    if (IsSelected())
+    if (this->IsSelected())
     {
         /* Get selection range */
         SizeType start, end;
-        GetSelection(start, end);
+        this->GetSelection(start, end);
 
         /* Locate cursor to the selection start */
-        selectionEnabled = false;
-        SetCursorPosition(start);
+        this->selectionEnabled = false;
+        this->SetCursorPosition(start);
 
-        /* Remove the selected amount of characters from the start position */
+        /* Remove the selected characters from the start position at once */
         auto erasePos = GetTextPosition(start);
-
-        for (; start < end; ++start)
-            text_.Remove(erasePos.y, erasePos.x);
+        text_.Remove(erasePos.y, erasePos.x, end - start);
     }
 }
 
-bool TextFieldMultiLineString::IsValidChar(Char chr) const
+template <typename T>
+bool BasicTextFieldMultiLineString<T>::IsValidChar(T chr) const
 {
     return (unsigned(chr) >= 32 || chr == '\r' || chr == '\n');
 }
 
-void TextFieldMultiLineString::SetText(const String& text)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::SetText(const StringType& text)
 {
     text_.SetText(text);
-    UpdateCursorRange();
+    this->UpdateCursorRange();
 }
 
-const String& TextFieldMultiLineString::GetText() const
+template <typename T>
+const typename BasicTextFieldMultiLineString<T>::StringType& BasicTextFieldMultiLineString<T>::GetText() const
 {
     return text_.GetText();
 }
 
-void TextFieldMultiLineString::SetMaxWidth(int maxWidth)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::SetMaxWidth(int maxWidth)
 {
     if (GetMaxWidth() != maxWidth)
     {
@@ -349,25 +371,38 @@ void TextFieldMultiLineString::SetMaxWidth(int maxWidth)
     }
 }
 
-const MultiLineString::TextLine& TextFieldMultiLineString::GetLine() const
+template <typename T>
+typename BasicTextFieldMultiLineString<T>::SizeType BasicTextFieldMultiLineString<T>::TrimFront(SizeType maxLines, SizeType maxLength)
+{
+    auto length = text_.TrimFront(maxLines, maxLength);
+    if (length > 0)
+        this->ShiftCursorRange(length);
+    return length;
+}
+
+template <typename T>
+const typename BasicTextFieldMultiLineString<T>::TextLine& BasicTextFieldMultiLineString<T>::GetLine() const
 {
     return GetLine(GetCursorCoordinate().y);
 }
 
-const MultiLineString::TextLine& TextFieldMultiLineString::GetLine(std::size_t lineIndex) const
+template <typename T>
+const typename BasicTextFieldMultiLineString<T>::TextLine& BasicTextFieldMultiLineString<T>::GetLine(std::size_t lineIndex) const
 {
-    static const MultiLineString::TextLine dummyLine;
+    static const TextLine dummyLine;
     if (lineIndex < GetLines().size())
         return GetLines()[lineIndex];
     return dummyLine;
 }
 
-const String& TextFieldMultiLineString::GetLineText() const
+template <typename T>
+const typename BasicTextFieldMultiLineString<T>::StringType& BasicTextFieldMultiLineString<T>::GetLineText() const
 {
     return GetLine().text;
 }
 
-const String& TextFieldMultiLineString::GetLineText(std::size_t lineIndex) const
+template <typename T>
+const typename BasicTextFieldMultiLineString<T>::StringType& BasicTextFieldMultiLineString<T>::GetLineText(std::size_t lineIndex) const
 {
     return GetLine(lineIndex).text;
 }
@@ -377,7 +412,8 @@ const String& TextFieldMultiLineString::GetLineText(std::size_t lineIndex) const
  * ======= Private: =======
  */
 
-void TextFieldMultiLineString::InsertChar(Char chr, bool wasSelected)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::InsertChar(T chr, bool wasSelected)
 {
     /* Replace '\r' by '\n' */
     if (chr == '\r')
@@ -385,30 +421,113 @@ void TextFieldMultiLineString::InsertChar(Char chr, bool wasSelected)
 
     /* Insert the new character (only use insertion if selection was not replaced) */
     auto coord = GetCursorCoordinate();
-    text_.Insert(coord.y, coord.x, chr, (insertionEnabled && !wasSelected));
+    text_.Insert(coord.y, coord.x, chr, (this->insertionEnabled && !wasSelected));
 }
 
-bool TextFieldMultiLineString::IsUpperLineEmpty() const
+template <typename T>
+void BasicTextFieldMultiLineString<T>::InsertText(const StringType& text, bool wasSelected)
+{
+    /* Replace '\r' by '\n' */
+    auto str = text;
+    std::replace(str.begin(), str.end(), T('\r'), T('\n'));
+
+    /* Insert the new text (only use insertion if selection was not replaced) */
+    auto coord = GetCursorCoordinate();
+    text_.Insert(coord.y, coord.x, str, (this->insertionEnabled && !wasSelected));
+
+    /* Move cursor to the end of the new text */
+    this->SetCursorPosition(this->GetCursorPosition() + str.size());
+    StoreCursorCoordX();
+}
+
+template <typename T>
+bool BasicTextFieldMultiLineString<T>::IsUpperLineEmpty() const
 {
     return GetLines()[GetCursorCoordinate().y - 1].text.empty();
 }
 
-bool TextFieldMultiLineString::IsLowerLineEmpty() const
+template <typename T>
+bool BasicTextFieldMultiLineString<T>::IsLowerLineEmpty() const
 {
     return GetLines()[GetCursorCoordinate().y + 1].text.empty();
 }
 
-void TextFieldMultiLineString::StoreCursorCoordX()
+template <typename T>
+void BasicTextFieldMultiLineString<T>::StoreCursorCoordX()
 {
-    auto cursorCoord = GetCursorCoordinate();
-    storedCursorCoordX_ = GetXCoordinateFromPosition(cursorCoord.x, cursorCoord.y);
+    auto& cache = GetCursorCache();
+
+    if (!cache.hasCoordX)
+    {
+        cache.coordX    = GetXCoordinateFromPosition(cache.coord.x, cache.coord.y);
+        cache.hasCoordX = true;
+    }
+
+    storedCursorCoordX_ = cache.coordX;
 }
 
-void TextFieldMultiLineString::RestoreCursorCoordX(SizeType lineIndex)
+template <typename T>
+void BasicTextFieldMultiLineString<T>::RestoreCursorCoordX(SizeType lineIndex)
 {
     SetCursorCoordinate(GetXPositionFromCoordinate(storedCursorCoordX_, lineIndex), lineIndex);
 }
 
+template <typename T>
+typename BasicTextFieldMultiLineString<T>::CursorCache& BasicTextFieldMultiLineString<T>::GetCursorCache() const
+{
+    auto position = this->GetCursorPosition();
+    auto layoutVersion = text_.GetLayoutVersion();
+
+    if (cursorCache_.valid && cursorCache_.position == position && cursorCache_.layoutVersion == layoutVersion)
+        return cursorCache_;
+
+    Point coord;
+
+    const auto& lines = GetLines();
+
+    if (!lines.empty() && !GetText().empty())
+    {
+        auto index = std::min(position, GetText().size());
+
+        /* Try the previous cursor line and its neighbors first, before searching all lines */
+        auto hint = std::min(cursorCache_.coord.y, lines.size() - 1);
+
+        if (IsIndexInLine(index, hint))
+            coord.y = hint;
+        else if (hint + 1 < lines.size() && IsIndexInLine(index, hint + 1))
+            coord.y = hint + 1;
+        else if (hint > 0 && IsIndexInLine(index, hint - 1))
+            coord.y = hint - 1;
+        else
+            coord.y = GetTextPosition(index).y;
+
+        const auto& line = lines[coord.y];
+        coord.x = std::min(index - line.offset, line.text.size());
+    }
+
+    /* Store new cursor coordinate (the X coordinate in pixels is only determined on demand) */
+    cursorCache_.position       = position;
+    cursorCache_.layoutVersion  = layoutVersion;
+    cursorCache_.coord          = coord;
+    cursorCache_.hasCoordX      = false;
+    cursorCache_.valid          = true;
+
+    return cursorCache_;
+}
+
+template <typename T>
+bool BasicTextFieldMultiLineString<T>::IsIndexInLine(SizeType index, SizeType lineIndex) const
+{
+    const auto& lines = GetLines();
+    return (lines[lineIndex].offset <= index && (lineIndex + 1 == lines.size() || index < lines[lineIndex + 1].offset));
+}
+
+
+template class BasicTextFieldMultiLineString<char>;
+template class BasicTextFieldMultiLineString<char16_t>;
+template class BasicTextFieldMultiLineString<char32_t>;
+template class BasicTextFieldMultiLineString<wchar_t>;
+
 
 } // /namespace Tg
 
@@ -13,179 +13,170 @@ namespace Tg
 {
 
 
-TextFieldString::TextFieldString(const String& str) :
+template <typename T>
+BasicTextFieldString<T>::BasicTextFieldString(const StringType& str) :
     text_ { str }
 {
 }
 
-TextFieldString& TextFieldString::operator = (const String& str)
+template <typename T>
+BasicTextFieldString<T>& BasicTextFieldString<T>::operator = (const StringType& str)
 {
     SetText(str);
     return *this;
 }
 
-TextFieldString& TextFieldString::operator += (const String& str)
+template <typename T>
+BasicTextFieldString<T>& BasicTextFieldString<T>::operator += (const StringType& str)
 {
-    for (const auto& chr : str)
-        Insert(chr);
+    this->Insert(str);
     return *this;
 }
 
-TextFieldString& TextFieldString::operator += (const Char& chr)
+template <typename T>
+BasicTextFieldString<T>& BasicTextFieldString<T>::operator += (const T& chr)
 {
-    Insert(chr);
+    this->Insert(chr);
     return *this;
 }
 
 /* --- Cursor operations --- */
 
-void TextFieldString::MoveCursor(int direction)
+template <typename T>
+void BasicTextFieldString<T>::MoveCursor(int direction)
 {
-    /* Get line size and quit if moving the cursor is not possible */
-    auto size = GetText().size();
-    if (size == 0)
+    /* Quit if moving the cursor is not possible */
+    if (GetText().empty())
         return;
 
-    auto AdjustDir = [size](SizeType& p)
-    {
-        --p;
-        p -= (p / size)*size;
-    };
+    /* Move cursor character by character, so that it never stops within a character */
+    auto pos = this->GetCursorPosition();
 
-    if (direction < 0)
+    for (; direction < 0; ++direction)
     {
-        auto dir = static_cast<SizeType>(-direction);
-
-        if (GetCursorPosition() >= dir)
+        if (pos > 0)
         {
             /* Move cursor left */
-            SetCursorPosition(GetCursorPosition() - dir);
+            pos = PrevCodePoint(text_, pos);
         }
-        else
+        else if (cursorLoopEnabled)
         {
-            if (cursorLoopEnabled)
-            {
-                /* Locate cursor to the end and move on (subtract all repeated loops) */
-                AdjustDir(dir);
-                SetCursorPosition(size - dir);
-            }
-            else
-            {
-                /* Locate cursor to the beginning */
-                MoveCursorBegin();
-            }
+            /* Locate cursor to the end and move on */
+            pos = text_.size();
         }
+        else
+            break;
     }
-    else if (direction > 0)
-    {
-        auto dir = static_cast<SizeType>(direction);
 
-        if (GetCursorPosition() + dir <= size)
+    for (; direction > 0; --direction)
+    {
+        if (pos < text_.size())
         {
             /* Move cursor right */
-            SetCursorPosition(GetCursorPosition() + dir);
+            pos = NextCodePoint(text_, pos);
         }
-        else
+        else if (cursorLoopEnabled)
         {
-            if (cursorLoopEnabled)
-            {
-                /* Locate cursor to the beginning and move on (subtract all repeated loops) */
-                AdjustDir(dir);
-                SetCursorPosition(dir);
-            }
-            else
-            {
-                /* Locate cursor to the end */
-                MoveCursorEnd();
-            }
+            /* Locate cursor to the beginning and move on */
+            pos = 0;
         }
+        else
+            break;
     }
+
+    this->SetCursorPosition(pos);
 }
 
-void TextFieldString::MoveCursorBegin()
+template <typename T>
+void BasicTextFieldString<T>::MoveCursorBegin()
 {
-    SetCursorPosition(0);
+    this->SetCursorPosition(0);
 }
 
-void TextFieldString::MoveCursorEnd()
+template <typename T>
+void BasicTextFieldString<T>::MoveCursorEnd()
 {
-    SetCursorPosition(GetText().size());
+    this->SetCursorPosition(GetText().size());
 }
 
 /* --- String content --- */
 
-Char TextFieldString::CharLeft() const
+template <typename T>
+T BasicTextFieldString<T>::CharLeft() const
 {
-    return (!IsCursorBegin() ? GetText()[GetCursorPosition() - 1] : Char(0));
+    return (!this->IsCursorBegin() ? GetText()[this->GetCursorPosition() - 1] : T(0));
 }
 
-Char TextFieldString::CharRight() const
+template <typename T>
+T BasicTextFieldString<T>::CharRight() const
 {
-    return (!IsCursorEnd() ? GetText()[GetCursorPosition()] : Char(0));
+    return (!this->IsCursorEnd() ? GetText()[this->GetCursorPosition()] : T(0));
 }
 
-void TextFieldString::RemoveLeft()
+template <typename T>
+void BasicTextFieldString<T>::RemoveLeft()
 {
-    if (IsSelected())
+    if (this->IsSelected())
     {
         /* First remove selection */
         RemoveSelection();
     }
-    else if (!IsCursorBegin())
+    else if (!this->IsCursorBegin())
     {
-        /* Remove character and then move cursor left */
+        /* Move cursor left and then remove character */
+        auto end = this->GetCursorPosition();
         MoveCursor(-1);
-        if (IsCursorEnd())
-            text_.pop_back();
-        else
-            text_.erase(Iter());
+        text_.erase(this->GetCursorPosition(), end - this->GetCursorPosition());
     }
 }
 
-void TextFieldString::RemoveRight()
+template <typename T>
+void BasicTextFieldString<T>::RemoveRight()
 {
-    if (IsSelected())
+    if (this->IsSelected())
     {
         /* First remove selection */
         RemoveSelection();
     }
-    else if (!IsCursorEnd())
+    else if (!this->IsCursorEnd())
     {
         /* Only remove character without moving the cursor */
-        if ((GetCursorPosition() + 1) == text_.size())
-            text_.pop_back();
-        else
-            text_.erase(Iter());
+        auto pos = this->GetCursorPosition();
+        text_.erase(pos, NextCodePoint(text_, pos) - pos);
     }
 }
 
-void TextFieldString::RemoveSelection()
+template <typename T>
+void BasicTextFieldString<T>::RemoveSelection()
 {
     /* Get selection range */
     SizeType start, end;
-    GetSelection(start, end);
+    this->GetSelection(start, end);
 
     /* Remove sub string */
     if (start < end)
         text_.erase(start, end - start);
 
     /* Locate cursor to the selection start */
-    selectionEnabled = false;
-    SetCursorPosition(start);
+    this->selectionEnabled = false;
+    this->SetCursorPosition(start);
 }
 
-bool TextFieldString::IsValidChar(Char chr) const
+template <typename T>
+bool BasicTextFieldString<T>::IsValidChar(T chr) const
 {
     return (unsigned(chr) >= 32);
 }
 
-void TextFieldString::SetText(const String& text)
+template <typename T>
+void BasicTextFieldString<T>::SetText(const StringType& text)
 {
     text_ = text;
-    UpdateCursorRange();
+    this->UpdateCursorRange();
 }
 
-const String& TextFieldString::GetText() const
+template <typename T>
+const typename BasicTextFieldString<T>::StringType& BasicTextFieldString<T>::GetText() const
 {
     return text_;
 }
@@ -195,9 +186,10 @@ const String& TextFieldString::GetText() const
  * ======= Private: =======
  */
 
-void TextFieldString::InsertChar(Char chr, bool wasSelected)
+template <typename T>
+void BasicTextFieldString<T>::InsertChar(T chr, bool wasSelected)
 {
-    if (IsCursorEnd())
+    if (this->IsCursorEnd())
     {
         /* Push back the new character */
         text_ += chr;
@@ -205,24 +197,51 @@ void TextFieldString::InsertChar(Char chr, bool wasSelected)
     else
     {
         /* Insert the new character (only use insertion if selection was not replaced) */
-        if (insertionEnabled && !wasSelected)
-            text_[GetCursorPosition()] = chr;
+        auto pos = this->GetCursorPosition();
+        if (this->insertionEnabled && !wasSelected && !IsContinuationUnit(chr))
+            text_.replace(pos, NextCodePoint(text_, pos) - pos, 1, chr);
         else
             text_.insert(Iter(), chr);
     }
 }
 
-String::iterator TextFieldString::Iter()
+template <typename T>
+void BasicTextFieldString<T>::InsertText(const StringType& text, bool wasSelected)
+{
+    /* Find end of the characters to be replaced (only use insertion if selection was not replaced) */
+    auto pos = this->GetCursorPosition();
+    auto replaceEnd = pos;
+
+    if (this->insertionEnabled && !wasSelected)
+    {
+        for (SizeType i = 0; i < text.size() && replaceEnd < text_.size(); i = NextCodePoint(text, i))
+            replaceEnd = NextCodePoint(text_, replaceEnd);
+    }
+
+    /* Insert the new text and move cursor to its end */
+    text_.replace(pos, replaceEnd - pos, text);
+    this->SetCursorPosition(pos + text.size());
+}
+
+template <typename T>
+typename BasicTextFieldString<T>::StringType::iterator BasicTextFieldString<T>::Iter()
 {
-    return (text_.begin() + GetCursorPosition());
+    return (text_.begin() + this->GetCursorPosition());
 }
 
-String::const_iterator TextFieldString::Iter() const
+template <typename T>
+typename BasicTextFieldString<T>::StringType::const_iterator BasicTextFieldString<T>::Iter() const
 {
-    return (text_.begin() + GetCursorPosition());
+    return (text_.begin() + this->GetCursorPosition());
 }
 
 
+template class BasicTextFieldString<char>;
+template class BasicTextFieldString<char16_t>;
+template class BasicTextFieldString<char32_t>;
+template class BasicTextFieldString<wchar_t>;
+
+
 } // /namespace Tg
 
 
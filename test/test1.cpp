@@ -42,11 +42,58 @@ void saveImagePNG(const Image& image, const std::string& filename)
     stbi_write_png(filename.c_str(), image.GetSize().width, image.GetSize().height, 1, image.GetImageBuffer().data(), image.GetSize().width);
 }
 
+void benchmarkTextWidth()
+{
+    // Setup synthetic glyph set with varying advances
+    FontGlyphSet glyphSet;
+    glyphSet.SetGlyphRange({ 0, 255 });
+
+    for (int i = 0; i < 256; ++i)
+        glyphSet[static_cast<wchar_t>(i)].advance = 3 + i % 13;
+
+    glyphSet.UpdateAdvanceTable();
+
+    std::string text(1 << 20, ' ');
+    for (std::size_t i = 0; i < text.size(); ++i)
+        text[i] = static_cast<char>(32 + (i * 7) % 95);
+
+    const int numRuns = 100;
+
+    // Measure scalar loop
+    int widthScalar = 0;
+    auto startTime = std::chrono::system_clock::now();
+    for (int i = 0; i < numRuns; ++i)
+        widthScalar += glyphSet.TextWidth<char>(text, 0);
+    auto endTime = std::chrono::system_clock::now();
+    std::cout << "text width (scalar loop): " << std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() << " us" << std::endl;
+
+    // Measure advance table kernel
+    int widthKernel = 0;
+    startTime = std::chrono::system_clock::now();
+    for (int i = 0; i < numRuns; ++i)
+        widthKernel += glyphSet.TextWidth(text, 0);
+    endTime = std::chrono::system_clock::now();
+    std::cout << "text width (advance table): " << std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() << " us" << std::endl;
+
+    if (widthScalar != widthKernel)
+        std::cerr << "text width mismatch: " << widthScalar << " != " << widthKernel << std::endl;
+
+    // Measure text fit kernel against the scalar loop
+    int fitWidthScalar = 0, fitWidthKernel = 0;
+    auto fitScalar = glyphSet.TextFit<char>(text, 0, std::string::npos, widthKernel / numRuns / 2, fitWidthScalar);
+    auto fitKernel = glyphSet.TextFit(text, 0, std::string::npos, widthKernel / numRuns / 2, fitWidthKernel);
+
+    if (fitScalar != fitKernel || fitWidthScalar != fitWidthKernel)
+        std::cerr << "text fit mismatch: " << fitScalar << " != " << fitKernel << std::endl;
+}
+
 int main()
 {
     std::cout << "Typographia Test 1" << std::endl;
     std::cout << "==================" << std::endl;
 
+    benchmarkTextWidth();
+
     FontDescription fontDesc;
     FontGlyphRange glyphRange;
 
@@ -256,7 +256,7 @@ bool initScene()
     mainTextField.cursorLoopEnabled = true;
 
     terminal->out << "Terminal Example" << std::endl;
-    terminal->out << "This should be overwritten!\rOVERWRITTEN";
+    terminal->out << "This should be overwritten!\rOVERWRITTEN" << std::flush;
 
     return true;
 }
@@ -607,7 +607,18 @@ void reshapeCallback(GLsizei w, GLsizei h)
 void putChar(const std::string& s)
 {
     if (showTerminal)
-        terminal->out << s;
+    {
+        if (s == "\r" || s == "\n")
+        {
+            /* Commit input line and respond to each line */
+            terminal->CommitInput();
+            std::string line;
+            while (std::getline(terminal->in, line))
+                terminal->out << "echo: " << line << std::endl;
+        }
+        else
+            terminal->textField.Put(s);
+    }
     else if (focusOnTextArea)
     {
         mainMlText->Put(s);